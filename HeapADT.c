@@ -140,7 +140,7 @@ void insertHeapItem(Heap aHeap, const void * item) {
     assert(aHeap != NULL);
     if(aHeap->num == aHeap->capacity) { // ensure heap is not at capacity
         aHeap->data = realloc(aHeap->data, 
-                        sizeof(struct Heap_S) * (aHeap->capacity * 2));
+                        sizeof(void*) * (aHeap->capacity * 2));
         aHeap->capacity *= 2;
 //        fprintf(stderr, "The heap is at capacity.\n");
 //        assert(aHeap->num != aHeap->capacity);
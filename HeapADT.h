@@ -0,0 +1,88 @@
+/// File: HeapADT.h
+/// Description: a heap of pointers ordered by a client comparison function
+/// Author: Nicholas Chieppa nrc4687@rit.edu
+///
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#ifndef HEAPADT
+#define HEAPADT
+
+typedef struct Heap_S* Heap;
+
+/**
+ * createHeap()
+ *      creates a new heap and returns a pointer to the client
+ * args -
+ *      capacity - the amount of items the heap holds before it grows
+ *      compFun - returns a value below 0 when lhs belongs above rhs
+ *      dumpEntry - prints an item for dumpHeap()
+ * returns -
+ *      a pointer to an empty heap
+ */
+Heap createHeap( size_t capacity
+               , int (*compFun) (const void * lhs, const void * rhs)
+               , void (*dumpEntry) (const void * item, FILE* outfp));
+
+/**
+ * destroyHeap()
+ *      deallocates memory from a valid heap, the items are the
+ *      client's to free
+ * args -
+ *      aHeap - the heap to free
+ */
+void destroyHeap(Heap aHeap);
+
+/**
+ * sizeHeap()
+ *      reports the size of the heap to the client
+ * args -
+ *      aHeap - the heap
+ * returns -
+ *      the amount of items in the heap
+ */
+size_t sizeHeap(Heap aHeap);
+
+/**
+ * topHeap()
+ *      reports the entry from the top of the heap to the client
+ * args -
+ *      aHeap - a heap that is not empty
+ * returns -
+ *      the item at the top of the heap
+ */
+const void * topHeap(const Heap aHeap);
+
+/**
+ * removeTopHeap()
+ *      removes the value at the top of the heap and
+ *      reports the value removed to the client
+ * args -
+ *      aHeap - a heap that is not empty
+ * returns -
+ *      the item removed
+ */
+void * removeTopHeap(Heap aHeap);
+
+/**
+ * insertHeapItem()
+ *      insert a new item into the heap, the heap is then
+ *      resorted based on the comparison function attached to the heap
+ * args -
+ *      aHeap - the heap
+ *      item - the item to insert
+ */
+void insertHeapItem(Heap aHeap, const void * item);
+
+/**
+ * dumpHeap()
+ *      prints the order that the heap is storing items using
+ *      the heaps dump entry function
+ * args -
+ *      aHeap - the heap
+ *      outfp - location to print the items
+ */
+void dumpHeap(Heap aHeap, FILE * outfp);
+
+#endif // HEAPADT
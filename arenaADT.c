@@ -0,0 +1,132 @@
+/// File: arenaADT.c
+/// Description: implementation of arenaADT.h
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/types.h>
+#include "mazestats.h"
+
+#define ALIGNMENT 16 /// every allocation starts on this boundary
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+#define MIN_BLOCK 4096 /// smallest block requested from the system
+
+/// a block of memory that allocations are carved from
+typedef struct ARENA_BLOCK_ST {
+    struct ARENA_BLOCK_ST* next; /// the block to use once this one is full
+    size_t size; /// usable bytes in the block
+    size_t used; /// bytes handed out from the block
+    void* data; /// the usable bytes, aligned to ALIGNMENT
+} Block;
+
+struct ARENA_ST {
+    Block* first; /// allocation restarts here after a reset
+    Block* current; /// the block allocations are carved from
+    size_t reserved; /// total bytes of every block
+};
+
+#include "arenaADT.h"
+
+/**
+ * create_block()
+ *      request a new block from the system
+ * args -
+ *      size - usable bytes needed in the block
+ * returns -
+ *      a pointer to an empty block
+ */
+static Block* create_block(size_t size) {
+    Block* block = malloc(ALIGN(sizeof(Block)) + size);
+    assert(block != NULL);
+    STAT_ADD(STAT_BLOCKS, 1);
+    STAT_ADD(STAT_BLOCK_BYTES, size);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    block->data = (char*)block + ALIGN(sizeof(Block));
+    return block;
+}
+
+/// Implementation from arenaADT.h
+/// arena_create()
+///     create an empty arena
+Arena arena_create(size_t block_size) {
+    Arena arena = (Arena)malloc(sizeof(struct ARENA_ST));
+    assert(arena != NULL);
+    block_size = ALIGN((block_size < MIN_BLOCK)?MIN_BLOCK:block_size);
+    arena->first = arena->current = create_block(block_size);
+    arena->reserved = block_size;
+    return arena;
+}
+
+/// Implementation from arenaADT.h
+/// arena_destroy()
+///     returns every block of the arena to the system
+void arena_destroy(Arena arena) {
+    if(arena == NULL) return;
+    while(arena->first != NULL) {
+        Block* next = arena->first->next;
+        free(arena->first);
+        arena->first = next;
+    }
+    free(arena);
+}
+
+/// Implementation from arenaADT.h
+/// arena_reset()
+///     releases everything allocated from the arena in constant time,
+///     later blocks are emptied as allocation reaches them again
+void arena_reset(Arena arena) {
+    arena->current = arena->first;
+    arena->first->used = 0;
+}
+
+/// Implementation from arenaADT.h
+/// arena_alloc()
+///     allocate memory from the arena
+void* arena_alloc(Arena arena, size_t size) {
+    size = ALIGN(size);
+    STAT_ADD(STAT_ARENA_ALLOCS, 1);
+    STAT_ADD(STAT_ARENA_BYTES, size);
+    Block* block = arena->current;
+    while(block->size - block->used < size) {
+        // blocks past the current one hold nothing since the last reset,
+        // one too small is freed so a reused arena never keeps it around
+        while(block->next != NULL && block->next->size < size) {
+            Block* small = block->next;
+            block->next = small->next;
+            arena->reserved -= small->size;
+            free(small);
+        }
+        if(block->next == NULL) {
+            // grow geometrically so a large search needs few blocks
+            size_t grown = 2 * block->size;
+            block->next = create_block((grown < size)?size:grown);
+            arena->reserved += block->next->size;
+        }
+        block = block->next;
+        block->used = 0; // left over from before the last reset
+    }
+    arena->current = block;
+    void* memory = (char*)block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+/// Implementation from arenaADT.h
+/// arena_calloc()
+///     allocate zeroed memory from the arena
+void* arena_calloc(Arena arena, size_t count, size_t size) {
+    void* memory = arena_alloc(arena, count * size);
+    memset(memory, 0, count * size);
+    return memory;
+}
+
+/// Implementation from arenaADT.h
+/// arena_reserved()
+///     reports the bytes the arena holds from the system
+size_t arena_reserved(Arena arena) {
+    return arena->reserved;
+}
@@ -0,0 +1,75 @@
+/// File: arenaADT.h
+/// Description: a bump allocator, memory is handed out in order from
+///     large blocks and everything is released at once by a reset
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <sys/types.h>
+
+#ifndef ARENAADT
+#define ARENAADT
+
+typedef struct ARENA_ST* Arena;
+
+/**
+ * arena_create()
+ *      create an empty arena
+ * args -
+ *      block_size - bytes requested from the system for the first block
+ * returns -
+ *      a pointer to an empty arena
+ */
+Arena arena_create(size_t block_size);
+
+/**
+ * arena_destroy()
+ *      returns every block of the arena to the system
+ * args -
+ *      arena - the arena to free
+ */
+void arena_destroy(Arena arena);
+
+/**
+ * arena_reset()
+ *      releases everything allocated from the arena in constant time,
+ *      the blocks are kept and reused by later allocations
+ * args -
+ *      arena - the arena to reset
+ */
+void arena_reset(Arena arena);
+
+/**
+ * arena_alloc()
+ *      allocate memory from the arena, the memory lives until
+ *      the arena is reset or destroyed
+ * args -
+ *      arena - the arena to allocate from
+ *      size - the amount of bytes needed
+ * returns -
+ *      a pointer to size bytes aligned for any type
+ */
+void* arena_alloc(Arena arena, size_t size);
+
+/**
+ * arena_calloc()
+ *      allocate zeroed memory from the arena
+ * args -
+ *      arena - the arena to allocate from
+ *      count - the amount of elements
+ *      size - the size of an element
+ * returns -
+ *      a pointer to count * size zeroed bytes aligned for any type
+ */
+void* arena_calloc(Arena arena, size_t count, size_t size);
+
+/**
+ * arena_reserved()
+ *      reports the bytes the arena holds from the system
+ * args -
+ *      arena - the arena to inspect
+ * returns -
+ *      the total size of all blocks
+ */
+size_t arena_reserved(Arena arena);
+
+#endif // ARENAADT
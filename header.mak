@@ -1,2 +1,3 @@
 CC =    gcc
 CFLAGS = -ggdb -std=c99 -Wall -Wextra -pedantic
+CLIBFLAGS = -lm -lpthread
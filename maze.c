@@ -7,61 +7,455 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 #include <string.h>
-#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "queueADT.h"
-#include "stackADT.h"
-#include "HeapADT.h"
+#include "pqueueADT.h"
+#include "mazeparse.h"
+#include "mazeimpl.h"
+#include "mazestats.h"
 
+#define STREAM_CHUNK (1 << 16) /// bytes read per call when streaming a maze
+#define RENDER_CHUNK (1 << 20) /// bytes of printed rows gathered per write
+#define RENDER_MAP_MIN (1 << 20) /// smallest print written through a mapping
 
-struct MAZE_ST {
-    int* data;
-    int width;
-    int height;
+/// xxHash64 primes
+#define PRIME1 0x9E3779B185EBCA87ull
+#define PRIME2 0xC2B2AE3D27D4EB4Full
+#define PRIME3 0x165667B19E3779F9ull
+#define PRIME4 0x85EBCA77C2B2AE63ull
+#define PRIME5 0x27D4EB2F165667C5ull
+
+struct WORKSPACE_ST {
+    Arena search; /// the state of the last solve, reset by the next one
+    uint64_t* path; /// set bit for every cell on the last solution
+    size_t words; /// words path has room for, not counting the trailing zero
 };
 
-#include "maze.h"
+/**
+ * row_width()
+ *      finds the width of the first row of text, every row
+ *      of the maze is expected to be this many characters
+ *      including the seperating spaces and the newline. The row is
+ *      measured up to its newline so a bad character in it is
+ *      reported where it is by parse_row()
+ * args -
+ *      text - the text of the maze
+ *      length - bytes available in text
+ * returns -
+ *      the amount of characters used by one row
+ */
+static size_t row_width(const char* text, size_t length) {
+    const char* newline = memchr(text, '\n', length);
+    size_t span = (newline != NULL)?(size_t)(newline - text):length;
+    return (span % 2)?span + 1:span;
+}
 
-#define COORDS(y, x) (y*maze->width+x)
-#define ABOVE(index) (index - maze->width)
-#define BELOW(index) ((index + maze->width < maze->width*maze->height) \
-                            ?index+maze->width:-1)
-#define LEFT(index) ((index%maze->width)?index-1:-1)
-#define RIGHT(index) ((index%maze->width != maze->width - 1)?index+1:-1)
+/// Implementation from mazeimpl.h
+/// trim_length()
+///     finds the length of text once trailing whitespace is removed
+size_t trim_length(const char* text, size_t length) {
+    while(length && (text[length - 1] == '\n' || text[length - 1] == ' ' 
+                || text[length - 1] == '\r'))
+        length--;
+    return length;
+}
+
+/// Implementation from mazeimpl.h
+/// report_row_error()
+///     describe an invalid character found by parse_row()
+void report_row_error(const char* text, size_t length, 
+                size_t offset, int row, int width) {
+    const char* expected = (offset % 2 == 0)?"a digit":
+        (offset + 1 == 2 * (size_t)width)?"a newline":"a space";
+    if(offset >= length)
+        fprintf(stderr, "maze: row %i is cut short, expected %i cells\n", 
+                row + 1, width);
+    else if(text[offset] == '\n')
+        fprintf(stderr, "maze: row %i has %zu cells, expected %i\n", 
+                row + 1, (offset + 1) / 2, width);
+    else if(offset + 1 == 2 * (size_t)width && text[offset] == ' ')
+        fprintf(stderr, "maze: row %i has more than %i cells\n", 
+                row + 1, width);
+    else if(text[offset] >= ' ' && text[offset] <= '~')
+        fprintf(stderr, "maze: row %i, column %zu: expected %s, found '%c'\n",
+                row + 1, offset + 1, expected, text[offset]);
+    else
+        fprintf(stderr, "maze: row %i, column %zu: expected %s, "
+                "found byte 0x%02x\n", row + 1, offset + 1, expected, 
+                (unsigned char)text[offset]);
+}
+
+/// Implementation from mazeimpl.h
+/// allocate_maze()
+///     create a maze structure sized to hold width by height cells
+Maze allocate_maze(int width, int height, uint64_t* walls) {
+    Maze maze = (Maze)malloc(sizeof(struct MAZE_ST));
+    assert(maze != NULL);
+    maze->width = width;
+    maze->height = height;
+    maze->stride = (width + WORD_BITS - 1) / WORD_BITS;
+    maze->pitch = maze->stride * WORD_BITS;
+    maze->words = maze->stride * height;
+    maze->span = 0;
+    maze->tiled = 0;
+    size_t words = maze->words;
+    maze->walls = (walls)?walls:calloc(words + 1, sizeof(uint64_t));
+    maze->mapping = NULL;
+    maze->mapped = 0;
+    maze->wallRoom = (walls)?0:words;
+    maze->pathRoom = words;
+    maze->path = calloc(words + 1, sizeof(uint64_t));
+    assert(maze->walls != NULL && maze->path != NULL);
+    // search state is only allocated once the maze is solved
+    maze->search = NULL;
+    maze->visited = maze->steps = NULL;
+    maze->labels = NULL;
+    maze->regions = 0;
+    maze->weights = NULL;
+    maze->heaviest = 1;
+    return maze;
+}
+
+/**
+ * refit_maze()
+ *      gives a maze no longer needed the size of the next maze read,
+ *      its bitmaps are kept when they have room and every cell cleared
+ * args -
+ *      maze - the maze to refit, NULL for a new maze
+ *      width - cells per row
+ *      height - the amount of rows
+ *      walls - wall bitmap to adopt, NULL to use an empty one
+ *      room - words walls has room for besides the trailing zero
+ * returns -
+ *      a pointer to a maze structure
+ */
+static Maze refit_maze(Maze maze, int width, int height, uint64_t* walls,
+                size_t room) {
+    if(maze == NULL) {
+        maze = allocate_maze(width, height, walls);
+        if(walls != NULL) maze->wallRoom = room;
+        return maze;
+    }
+    size_t stride = (width + WORD_BITS - 1) / WORD_BITS;
+    size_t words = stride * height;
+    if(walls == NULL && maze->wallRoom >= words) {
+        walls = maze->walls;
+        room = maze->wallRoom;
+        memset(walls, 0, sizeof(uint64_t) * (words + 1));
+    } else if(walls == NULL) {
+        walls = calloc(words + 1, sizeof(uint64_t));
+        assert(walls != NULL);
+        room = words;
+    }
+    if(walls != maze->walls && maze->mapping != NULL) 
+        munmap(maze->mapping, maze->mapped);
+    else if(walls != maze->walls)
+        free(maze->walls);
+    maze->walls = walls;
+    maze->wallRoom = room;
+    maze->mapping = NULL;
+    maze->mapped = 0;
+    if(maze->pathRoom < words) {
+        free(maze->path);
+        maze->path = malloc(sizeof(uint64_t) * (words + 1));
+        assert(maze->path != NULL);
+        maze->pathRoom = words;
+    }
+    memset(maze->path, 0, sizeof(uint64_t) * (words + 1));
+
+    maze->width = width;
+    maze->height = height;
+    maze->stride = stride;
+    maze->pitch = stride * WORD_BITS;
+    maze->words = words;
+    maze->span = 0;
+    maze->tiled = 0;
+    // the search arena is kept for the next solve
+    maze->visited = maze->steps = NULL;
+    free(maze->labels);
+    maze->labels = NULL;
+    maze->regions = 0;
+    free(maze->weights);
+    maze->weights = NULL;
+    maze->heaviest = 1;
+    return maze;
+}
+
+/**
+ * parse_cells()
+ *      parse_row() for a row of a maze being read, a row stopped at a
+ *      weighted cell is read again with parse_weights(). The costs
+ *      of the cells are only kept once a weighted row is found, every
+ *      cell before it costs 1
+ * args -
+ *      text - the start of the row
+ *      length - the amount of characters available from text
+ *      width - the amount of cells in each row
+ *      row - the row being read, counting from 0
+ *      walls - the words of the row
+ *      weights - location of the costs of the maze row by row, NULL
+ *              while no weighted row has been read
+ *      rows - the amount of rows weights is made with room for
+ * returns -
+ *      PARSE_OK if the row is valid, otherwise the offset of
+ *      the first invalid character
+ */
+static size_t parse_cells(const char* text, size_t length, int width, 
+                size_t row, uint64_t* walls, uint8_t** weights, size_t rows) {
+    size_t bad = parse_row(text, length, width, walls);
+    if(bad == PARSE_OK || bad % 2 || bad >= length || text[bad] < '2' || 
+            text[bad] > '0' + MAX_WEIGHT)
+        return bad;
+    if(*weights == NULL) {
+        *weights = malloc((size_t)width * rows + 1);
+        assert(*weights != NULL);
+        memset(*weights, 1, (size_t)width * rows);
+    }
+    return parse_weights(text, length, width, walls, 
+                *weights + row * width);
+}
+
+/**
+ * set_weights()
+ *      gives a maze the costs of its cells
+ * args -
+ *      maze - the maze
+ *      weights - the cost of every cell row by row, or NULL. Freed
+ *              when the maze can't take them
+ * returns -
+ *      0 on success, -1 with a message printed to stderr if the maze
+ *      has more than MAX_WEIGHTED_CELLS cells
+ */
+static int set_weights(Maze maze, uint8_t* weights) {
+    if(weights != NULL && 
+            (size_t)maze->width * maze->height > MAX_WEIGHTED_CELLS) {
+        fprintf(stderr, "maze: a weighted maze may have at most %zu cells\n",
+                    MAX_WEIGHTED_CELLS);
+        free(weights);
+        return -1;
+    }
+    maze->weights = weights;
+    maze->heaviest = 1;
+    size_t cells = (size_t)maze->width * maze->height;
+    for(size_t cell = 0; weights != NULL && cell < cells; cell++)
+        if(weights[cell] > maze->heaviest) maze->heaviest = weights[cell];
+    return 0;
+}
+
+/**
+ * map_maze()
+ *      decode a maze directly out of a memory mapping of its file
+ * args -
+ *      text - the mapped file
+ *      size - the size of the mapping
+ *      reuse - a maze whose memory is reused, may be NULL, freed
+ *              when NULL is returned
+ * returns -
+ *      a pointer to a maze structure, NULL if a row is malformed
+ */
+static Maze map_maze(const char* text, size_t size, Maze reuse) {
+    size = trim_length(text, size);
+    size_t rowLength = row_width(text, size);
+    if(size && !rowLength) {
+        report_row_error(text, size, 0, 0, 0);
+        clean_maze(reuse);
+        return NULL;
+    }
+    size_t height = (rowLength)?(size + rowLength - 1) / rowLength:0;
+
+    Maze maze = refit_maze(reuse, rowLength / 2, height, NULL, 0);
+    uint8_t* weights = NULL;
+    for(int row = 0; row < maze->height; row++) {
+        const char* start = text + row * rowLength;
+        size_t length = size - row * rowLength;
+        if(length > rowLength) length = rowLength;
+        size_t bad = parse_cells(start, length, maze->width, row,
+                        maze->walls + row * maze->stride, &weights, height);
+        if(bad != PARSE_OK) {
+            report_row_error(start, length, bad, row, maze->width);
+            free(weights);
+            clean_maze(maze);
+            return NULL;
+        }
+    }
+    if(set_weights(maze, weights)) {
+        clean_maze(maze);
+        return NULL;
+    }
+    return maze;
+}
+
+/**
+ * stream_maze()
+ *      decode a maze from a stream that can not be mapped or seeked,
+ *      such as a pipe, reading it in fixed size chunks
+ * args -
+ *      input - input stream to get the maze from
+ *      reuse - a maze whose memory is reused, may be NULL, freed
+ *              when NULL is returned
+ * returns -
+ *      a pointer to a maze structure, NULL if a row is malformed
+ */
+static Maze stream_maze(FILE* input, Maze reuse) {
+    size_t capacity = STREAM_CHUNK, length = 0, rowLength = 0;
+    char* buffer = malloc(capacity);
+    assert(buffer != NULL);
+
+    uint64_t* walls = NULL;
+    uint8_t* weights = NULL;
+    size_t stride = 0, rows = 0, rowCapacity = 0;
+    int width = 0, done = 0, failed = 0;
+    
+    while(!done && !failed) {
+        if(capacity - length < STREAM_CHUNK) { // always room for a full chunk
+            capacity *= 2;
+            buffer = realloc(buffer, capacity);
+            assert(buffer != NULL);
+        }
+        size_t got = fread(buffer + length, 1, STREAM_CHUNK, input);
+        length += got;
+        done = (got == 0);
+
+        if(!rowLength) { // the width is only known once a full row is read
+            char* newline = memchr(buffer, '\n', length);
+            if(newline == NULL && !done) continue;
+            if(is_binary(buffer, length)) {
+                clean_maze(reuse);
+                Maze maze = stream_binary(input, buffer, length);
+                free(buffer);
+                return maze;
+            }
+            if(!trim_length(buffer, length)) break;
+            rowLength = row_width(buffer, length);
+            if(!rowLength) {
+                report_row_error(buffer, length, 0, 0, 0);
+                failed = 1;
+                break;
+            }
+            width = rowLength / 2;
+            stride = (width + WORD_BITS - 1) / WORD_BITS;
+            // rows are read into the walls of the maze being reused
+            if(reuse != NULL && stride && reuse->wallRoom >= stride) {
+                walls = reuse->walls;
+                rowCapacity = reuse->wallRoom / stride;
+                reuse->walls = NULL;
+                reuse->wallRoom = 0;
+            }
+        }
+
+        // whole rows are read as they arrive, 
+        // the last row is only known once the stream ends
+        size_t offset = 0;
+        size_t end = (done)?trim_length(buffer, length):length;
+        while(!failed && (end - offset >= rowLength || (done && end > offset))) {
+            if(rows == rowCapacity) {
+                rowCapacity = (rowCapacity)?rowCapacity * 2:64;
+                walls = realloc(walls, 
+                        sizeof(uint64_t) * (stride * rowCapacity + 1));
+                assert(walls != NULL);
+                if(weights != NULL) {
+                    weights = realloc(weights, (size_t)width * rowCapacity + 1);
+                    assert(weights != NULL);
+                    memset(weights + (size_t)width * rows, 1, 
+                            (size_t)width * (rowCapacity - rows));
+                }
+            }
+            size_t available = (end - offset < rowLength)?end - offset:rowLength;
+            size_t bad = parse_cells(buffer + offset, available, width, rows,
+                            walls + rows * stride, &weights, rowCapacity);
+            if(bad != PARSE_OK) {
+                report_row_error(buffer + offset, available, bad, rows, width);
+                failed = 1;
+            }
+            rows++;
+            offset += available;
+        }
+        // keep the partial row for the next chunk
+        memmove(buffer, buffer + offset, length - offset);
+        length -= offset;
+    }
+    free(buffer);
+
+    if(failed) {
+        free(walls);
+        free(weights);
+        clean_maze(reuse);
+        return NULL;
+    }
+    if(walls == NULL) width = rows = 0;
+    else walls[stride * rows] = 0;
+    Maze maze = refit_maze(reuse, width, rows, walls, stride * rowCapacity);
+    if(set_weights(maze, weights)) {
+        clean_maze(maze);
+        return NULL;
+    }
+    return maze;
+}
 
 /**
  * create_maze()
  *      create a maze structure from input
+ * 
+ *      regular files are memory mapped and decoded in place,
+ *      anything else is read as a stream. Files in the binary
+ *      format are recognized by their header, a mapped binary
+ *      file is used as the wall bitmap without being copied
  * args - 
  *      input - input stream to get the maze from
  * returns - 
- *      a pointer to a maze structure
+ *      a pointer to a maze structure, 
+ *      NULL if the input is not a valid maze, a message describing
+ *      the first malformed row is printed to stderr
  */
 Maze create_maze(FILE* input) {
-    Maze maze = (Maze)malloc(sizeof(struct MAZE_ST));
-    assert(maze != NULL);
+    return reload_maze(NULL, input);
+}
+
+/// Implementation from maze.h
+/// reload_maze()
+///     create_maze() into the memory of a maze that is no longer needed
+Maze reload_maze(Maze reuse, FILE* input) {
+    Maze maze = NULL;
+    struct stat info;
+    int fd = fileno(input), mapped = 0;
+
+    if(fd >= 0 && !fstat(fd, &info) && S_ISREG(info.st_mode) && info.st_size) {
+        // the file is mapped over an anonymous reservation one word longer,
+        // so a binary payload has the zeroed word past its end that 
+        // allocated bitmaps have
+        size_t size = info.st_size, reserved = size + sizeof(uint64_t);
+        char* text = mmap(NULL, reserved, PROT_READ | PROT_WRITE, 
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(text != MAP_FAILED && mmap(text, size, PROT_READ | PROT_WRITE, 
+                    MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+            mapped = 1;
+            if(is_binary(text, size)) {
+                clean_maze(reuse);
+                maze = map_binary(text, size);
+                if(maze != NULL) {
+                    maze->mapping = text;
+                    maze->mapped = reserved;
+                }
+            } else {
+                madvise(text, size, MADV_SEQUENTIAL);
+                maze = map_maze(text, size, reuse);
+            }
+            if(maze == NULL || maze->mapping == NULL) munmap(text, reserved);
+        } else if(text != MAP_FAILED) {
+            munmap(text, reserved);
+        }
+    }
+    if(!mapped)
+        maze = stream_maze(input, reuse);
 
-    maze->width = maze->height = 0;
-    
-    fseek(input, 0, SEEK_END);
-    long size = ftell(input);
-    fseek(input, 0, SEEK_SET);
-    char* wholeMaze = malloc(size + 1);
-    fread(wholeMaze, size, 1, input);
-    
-    maze->width = (int)strspn(wholeMaze, " 10");
-    if(maze->width % 2) maze->width++;
-    maze->height = size / maze->width;
-    maze->width /= 2;    
-    
-    maze->data = malloc(sizeof(int) * (maze->width * maze->height));
-    for(int i = 0, sp = 0; i < maze->width * maze->height; i++, sp += 2)
-        maze->data[i] = (int)strtol(wholeMaze + sp, NULL, 10);
-    free(wholeMaze);
     #ifdef DEBUG
-    fprintf(stdout,  "%ld\n", size);
-    printf("w%i h%i\n", maze->width, maze->height);
+    if(maze != NULL) printf("w%i h%i\n", maze->width, maze->height);
     #endif
     return maze;
 }
@@ -75,10 +469,231 @@ Maze create_maze(FILE* input) {
  */
 void clean_maze(Maze maze) {
     if(maze == NULL) return;
-    free(maze->data);
+    if(maze->mapping != NULL) munmap(maze->mapping, maze->mapped);
+    else free(maze->walls);
+    free(maze->path);
+    free(maze->labels);
+    free(maze->weights);
+    arena_destroy(maze->search);
     free(maze);
 }
 
+/// Implementation from maze.h
+/// maze_width()
+///     reports the amount of cells in each row of the maze
+int maze_width(const Maze maze) {
+    return maze->width;
+}
+
+/// Implementation from maze.h
+/// maze_height()
+///     reports the amount of rows in the maze
+int maze_height(const Maze maze) {
+    return maze->height;
+}
+
+/**
+ * rotate()
+ *      rotates a word left
+ */
+static uint64_t rotate(uint64_t word, int bits) {
+    return (word << bits) | (word >> (WORD_BITS - bits));
+}
+
+/**
+ * hash_round()
+ *      mixes one word into an xxHash64 lane
+ */
+static uint64_t hash_round(uint64_t lane, uint64_t word) {
+    return rotate(lane + word * PRIME2, 31) * PRIME1;
+}
+
+/// Implementation from mazeimpl.h
+/// hash_words()
+///     an xxHash64 style hash of an array of words
+uint64_t hash_words(const uint64_t* words, size_t count, uint64_t seed) {
+    size_t w = 0;
+    uint64_t hash;
+    if(count >= 4) {
+        // four independent lanes keep the multiplies in flight
+        uint64_t lanes[4] = {seed + PRIME1 + PRIME2, seed + PRIME2,
+                                seed, seed - PRIME1};
+        for(; w + 4 <= count; w += 4)
+            for(int l = 0; l < 4; l++)
+                lanes[l] = hash_round(lanes[l], words[w + l]);
+        hash = rotate(lanes[0], 1) + rotate(lanes[1], 7) +
+                rotate(lanes[2], 12) + rotate(lanes[3], 18);
+        for(int l = 0; l < 4; l++)
+            hash = (hash ^ hash_round(0, lanes[l])) * PRIME1 + PRIME4;
+    } else {
+        hash = seed + PRIME5;
+    }
+    hash += count * sizeof(uint64_t);
+    for(; w < count; w++)
+        hash = rotate(hash ^ hash_round(0, words[w]), 27) * PRIME1 + PRIME4;
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/// Implementation from maze.h
+/// save_maze()
+///     writes the maze's cells in a format create_maze() reads back
+int save_maze(const Maze maze, FILE* output, MazeFormat format) {
+    if(format == MAZE_BINARY)
+        return write_binary(maze, output);
+
+    // every cell is a digit and a space, the last space becomes the newline
+    char* row = malloc((size_t)maze->width * 2 + 1);
+    assert(row != NULL);
+    int failed = 0;
+    for(int y = 0; y < maze->height && !failed; y++) {
+        const uint8_t* weights = (maze->weights != NULL)?
+                maze->weights + (size_t)y * maze->width:NULL;
+        for(int x = 0; x < maze->width; x++) {
+            row[x * 2] = TEST_BIT(maze->walls, COORDS(y, x))?'1':
+                    (weights != NULL && weights[x] > 1)?'0' + weights[x]:'0';
+            row[x * 2 + 1] = ' ';
+        }
+        row[maze->width * 2 - 1] = '\n';
+        failed = fwrite(row, 1, maze->width * 2, output) != (size_t)maze->width * 2;
+    }
+    free(row);
+    return (failed)?-1:0;
+}
+
+/// Implementation from mazeimpl.h
+/// layout_walls()
+///     copies the wall bitmap of a maze into either layout
+uint64_t* layout_walls(const Maze maze, int tiled, size_t* words) {
+    // a word of a row is a row of a tile, so changing the layout only
+    // moves words and sets or clears the cells past the maze
+    size_t bands = (maze->height + TILE_EDGE) / TILE_SIDE;
+    size_t count = (tiled)?bands * TILE_SIDE * maze->stride:
+                    maze->stride * maze->height;
+    uint64_t* walls = malloc(sizeof(uint64_t) * (count + 1));
+    assert(walls != NULL);
+    uint64_t edge = (maze->width % WORD_BITS)?
+            ((uint64_t)1 << (maze->width % WORD_BITS)) - 1:~(uint64_t)0;
+    // padding rows of the last band of tiles are walls
+    for(size_t word = 0; tiled && word < count; word++)
+        walls[word] = ~(uint64_t)0;
+    for(size_t row = 0; row < (size_t)maze->height; row++)
+        for(size_t column = 0; column < maze->stride; column++) {
+            size_t rows = row * maze->stride + column;
+            size_t tiles = ((row / TILE_SIDE * maze->stride + column) << 
+                            TILE_SHIFT) + row % TILE_SIDE;
+            uint64_t mask = (column + 1 < maze->stride)?~(uint64_t)0:edge;
+            if(tiled)
+                walls[tiles] = maze->walls[rows] | ~mask;
+            else
+                walls[rows] = maze->walls[tiles] & mask;
+        }
+    walls[count] = 0;
+    if(words != NULL) *words = count;
+    return walls;
+}
+
+/// Implementation from maze.h
+/// set_maze_layout()
+///     changes how the cells of a maze are laid out in memory
+void set_maze_layout(Maze maze, MazeLayout layout) {
+    int tiled = (layout == MAZE_TILES);
+    if(tiled == maze->tiled) return;
+    size_t words;
+    uint64_t* walls = layout_walls(maze, tiled, &words);
+    if(maze->mapping != NULL) munmap(maze->mapping, maze->mapped);
+    else free(maze->walls);
+    maze->mapping = NULL;
+    maze->mapped = 0;
+    maze->walls = walls;
+    maze->wallRoom = words;
+    maze->words = words;
+    maze->tiled = tiled;
+    maze->span = (tiled)?maze->stride * TILE_CELLS:0;
+
+    // the solution and search state are sized for the old layout
+    free(maze->path);
+    maze->path = calloc(words + 1, sizeof(uint64_t));
+    assert(maze->path != NULL);
+    maze->pathRoom = words;
+    arena_destroy(maze->search);
+    maze->search = NULL;
+    maze->visited = maze->steps = NULL;
+}
+
+/// the two characters printed for a cell, indexed by its
+/// wall bit plus twice its path bit
+static const char CELL_TEXT[4][2] = {
+    {PATH_DISP, ' '}, {WALL_DISP, ' '}, {VALID_PATH, ' '}, {WALL_DISP, ' '}
+};
+
+/**
+ * render_line()
+ *      writes one line of the printed maze, every line including
+ *      the bounds is 2 * width + 4 characters
+ * args -
+ *      maze - the maze, or band of rows of a maze, to print
+ *      row - the row of maze to write, -1 and the height are the bounds
+ *      first - the row of the whole maze that row 0 of maze is
+ *      height - the amount of rows in the whole maze
+ *      line - where to write the line
+ */
+static void render_line(const Maze maze, int row, size_t first, 
+                size_t height, char* line) {
+    size_t width = maze->width, whole = first + row;
+    if(row < 0 || whole == height) {
+        line[0] = BOUND_SIDE;
+        // two bounds for each cell and one past the last
+        memset(line + 1, BOUND_TOP, 2 * width + 1);
+        line[2 * width + 2] = BOUND_SIDE;
+        line[2 * width + 3] = '\n';
+        return;
+    }
+    line[0] = (!whole)?' ':BOUND_SIDE;
+    line[1] = ' ';
+    char* cell = line + 2;
+    // 64 cells of a row are one word in either layout
+    for(size_t x = 0; x < width; x += WORD_BITS) {
+        size_t word = COORDS(row, x) / WORD_BITS;
+        uint64_t walls = maze->walls[word], path = maze->path[word];
+        size_t count = (width - x < WORD_BITS)?width - x:WORD_BITS;
+        for(size_t bit = 0; bit < count; bit++, cell += 2)
+            memcpy(cell, CELL_TEXT[((walls >> bit) & 1) | 
+                                    (((path >> bit) & 1) << 1)], 2);
+    }
+    cell[0] = (whole + 1 == height)?' ':BOUND_SIDE;
+    cell[1] = '\n';
+    STAT_ADD(STAT_CELLS_PRINTED, width);
+}
+
+/// Implementation from mazeimpl.h
+/// print_band()
+///     prints a band of rows the way pretty_print_maze() prints them
+void print_band(const Maze band, size_t first, size_t height, FILE* output) {
+    size_t line = 2 * (size_t)band->width + 4;
+    size_t lines = (line < RENDER_CHUNK)?RENDER_CHUNK / line:1;
+    char* buffer = malloc(line * lines);
+    assert(buffer != NULL);
+    // the bounds are printed with the first and last rows
+    int top = (first)?0:-1;
+    int bottom = (first + band->height == height)?band->height:band->height - 1;
+    size_t used = 0;
+    for(int row = top; row <= bottom; row++) {
+        render_line(band, row, first, height, buffer + used);
+        used += line;
+        if(used == line * lines || row == bottom) {
+            fwrite(buffer, 1, used, output);
+            used = 0;
+        }
+    }
+    free(buffer);
+}
+
+#ifdef DEBUG
 /**
  * print_horizontal_bound()
  *      used for printing either the vertical or horizontal bound on the maze
@@ -99,7 +714,8 @@ static void print_horizontal_bound(FILE* output, int length) {
 
 /**
  * pretty_print_maze()
- *      prints the maze cleanly
+ *      prints the maze cleanly, debug builds print the state of
+ *      every cell as a number instead
  * args-
  *      maze -  pointer to maze structure to print
  *      output - output stream to print the maze to
@@ -109,101 +725,212 @@ void pretty_print_maze(const Maze maze, FILE* output) {
     for(int row = 0; row < maze->height; row++) {
         fprintf(output, "%c ", (!row)?' ':BOUND_SIDE);
         for(int column = 0; column < maze->width; column++) {
-            #ifdef DEBUG
-            fprintf(output, "%i ", maze->data[row*maze->width + column]);
-            #else
-            fprintf(output, "%c ", 
-                (maze->data[row*maze->width + column] == 1)?WALL_DISP:
-                (maze->data[row*maze->width + column] > 1)?VALID_PATH:PATH_DISP);
-            #endif
+            size_t index = COORDS(row, column);
+            fprintf(output, "%i ", (TEST_BIT(maze->walls, index))?1:
+                (TEST_BIT(maze->path, index))?2:
+                (maze->visited && TEST_BIT(maze->visited, index))?-1:0);
         }
         fprintf(output, "%c\n", (row+1 == maze->height)?' ':BOUND_SIDE);
     }
     print_horizontal_bound(output, maze->width);
 }
+#else
+/**
+ * render_mapped()
+ *      prints the maze straight into the pages of a regular file
+ *      opened for reading and writing, the file is grown to fit
+ *      and the stream is left just past the maze
+ * args -
+ *      maze - the maze to print
+ *      output - the file to print to
+ *      line - the length of every line
+ *      total - the length of the whole print
+ * returns -
+ *      0 if the maze was printed, -1 if the output can't be
+ *      mapped, nothing is printed then
+ */
+static int render_mapped(const Maze maze, FILE* output, size_t line, 
+                size_t total) {
+    struct stat info;
+    int fd = fileno(output), flags;
+    if(fd < 0 || fflush(output) || fstat(fd, &info) || 
+            !S_ISREG(info.st_mode) || (flags = fcntl(fd, F_GETFL)) < 0 ||
+            (flags & O_ACCMODE) != O_RDWR || (flags & O_APPEND))
+        return -1;
+    off_t at = ftello(output);
+    if(at < 0) return -1;
+    // a mapping starts on a page boundary
+    off_t base = at - at % sysconf(_SC_PAGESIZE);
+    size_t length = (size_t)(at - base) + total;
+    if(info.st_size < at + (off_t)total && ftruncate(fd, at + total))
+        return -1;
+    char* text = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, 
+                    fd, base);
+    if(text == MAP_FAILED) {
+        // the file is put back the way it was for the write instead
+        if(info.st_size < at + (off_t)total && ftruncate(fd, info.st_size))
+            perror("ftruncate");
+        return -1;
+    }
+    char* next = text + (at - base);
+    for(int row = -1; row <= maze->height; row++, next += line)
+        render_line(maze, row, 0, maze->height, next);
+    munmap(text, length);
+    return (fseeko(output, at + total, SEEK_SET))?-1:0;
+}
 
-static double distance(int x1, int y1, int x2, int y2) {
-    return sqrt(((x1 - x2) * (x1 - x2)) + ((y1 - y2) * (y1 - y2)));
+/**
+ * pretty_print_maze()
+ *      prints the maze cleanly. Lines are rendered into a buffer
+ *      and written many at a time, or into the pages of the output
+ *      when it is a large print to a file that can be mapped
+ * args-
+ *      maze -  pointer to maze structure to print
+ *      output - output stream to print the maze to
+ */
+void pretty_print_maze(const Maze maze, FILE* output) {
+    size_t line = 2 * (size_t)maze->width + 4;
+    size_t total = line * ((size_t)maze->height + 2);
+    if(total < RENDER_MAP_MIN || render_mapped(maze, output, line, total))
+        print_band(maze, 0, maze->height, output);
 }
+#endif
 
-/// represent traversing through the maze
-typedef struct MAZE_TRAVELER_ST {
-    int to_visit; // the position on the map this traveler is assoicated with
-    float distance; // distance from to_vist to start
-    struct MAZE_TRAVELER_ST* prev; // the traveler that spawned this one
-} Traveler;
+/**
+ * exit_distance()
+ *      the squared distance from a cell to the exit corner,
+ *      squaring keeps the same ordering as the true distance
+ *      without leaving integers
+ * args -
+ *      maze - the maze the cell is in
+ *      index - the cell
+ * returns -
+ *      the squared euclidean distance to the exit corner
+ */
+static uint64_t exit_distance(const Maze maze, size_t index) {
+    uint64_t dx = maze->width - COLUMN(index);
+    uint64_t dy = maze->height - ROW(index);
+    return dx * dx + dy * dy;
+}
 
-void dumpTraveler(const void* item, FILE* outfp) {
-    fprintf(stdout, "dump\n");
+/**
+ * exit_steps()
+ *      the manhattan distance from a cell to the exit, this never
+ *      overestimates the steps left on a 4-connected grid
+ * args -
+ *      maze - the maze the cell is in
+ *      index - the cell
+ * returns -
+ *      the least amount of moves that could reach the exit
+ */
+static uint64_t exit_steps(const Maze maze, size_t index) {
+    return (maze->width - 1 - COLUMN(index)) + (maze->height - 1 - ROW(index));
 }
 
-int cmpTravelers(const void * lhs, const void* rhs) {
-    Traveler* t1 = (Traveler*)lhs;
-    Traveler* t2 = (Traveler*)rhs;
-    return t1->distance >= t2->distance;
+/// Implementation from mazeimpl.h
+/// astar_priority()
+///     f = g + h with the heuristic h in the low bits, so among equal f
+///     the cell closest to the exit (the one with the highest g) is first
+uint64_t astar_priority(const Maze maze, size_t index, uint64_t cost) {
+    uint64_t h = exit_steps(maze, index);
+    return ((cost + h) << TIE_BITS) | ((h < TIE_MASK)?h:TIE_MASK);
+}
+
+/// Implementation from mazeimpl.h
+/// astar_cost()
+///     recovers g from an A* priority
+uint64_t astar_cost(const Maze maze, size_t index, uint64_t rank) {
+    return (rank >> TIE_BITS) - exit_steps(maze, index);
+}
+
+/**
+ * priority()
+ *      the order a cell is taken out of the queue in
+ *
+ *      SOLVE_GREEDY ranks only by distance to the exit,
+ *      SOLVE_ASTAR by astar_priority()
+ * args -
+ *      maze - the maze the cell is in
+ *      solver - the search strategy
+ *      index - the cell
+ *      cost - the moves taken to reach the cell (g)
+ * returns -
+ *      the priority of the cell, lowest comes out first
+ */
+static uint64_t priority(const Maze maze, Solver solver, 
+                size_t index, uint64_t cost) {
+    if(solver == SOLVE_GREEDY)
+        return exit_distance(maze, index);
+    return astar_priority(maze, index, cost);
 }
 
 /**
- * create_traveler()
- *      create a pointer to a traveler object 
+ * cost()
+ *      recovers the moves taken to reach a cell from its priority
  * args -
- *      to_visit - the space this traveler is associated with
- *      distance - the distance from this poistion to the start
- *      prev     - the traveler that spawned this one
+ *      maze - the maze the cell is in
+ *      solver - the search strategy
+ *      index - the cell
+ *      rank - the priority the cell was queued with
  * returns -
- *      a pointer to a traveler 
+ *      g for SOLVE_ASTAR, 0 for strategies that do not track it
  */
-static Traveler* create_traveler(int to_visit, double distance, Traveler* prev) {
-    Traveler* traveler = malloc(sizeof(Traveler));
-    traveler->to_visit = to_visit;
-    traveler->distance = distance;
-    traveler->prev = prev;
-    return traveler;
+static uint64_t cost(const Maze maze, Solver solver, 
+                size_t index, uint64_t rank) {
+    if(solver == SOLVE_GREEDY) return 0;
+    return astar_cost(maze, index, rank);
 }
 
 /**
  * create_neighbors()
- *      find an create travelers to visit valid spaces 
- *      adjectent to the space on the maze that we are looking at.
- *      A valid space is one that is in bounds and 
- *      currently marked with a 0.
- *      After the space is traveled to it is marked with the indicator -1
+ *      queue the valid spaces adjectent to the space 
+ *      on the maze that we are looking at.
+ *      A valid space is one that is in bounds, not a wall
+ *      and not yet visited. Each queued item records the 
+ *      step taken to reach it so the path can be followed back.
  * args - 
- *      next - a pointer to a queue that will decide what space we will travel
- *             to next and iterate over
+ *      next - a priority queue that will decide what space we will 
+ *             travel to next and iterate over
  *      maze - a pointer to a maze to look at
- *      curr - the current space that we have traveled to
+ *      solver - the search strategy used to rank spaces
+ *      index - the current space that we have traveled to
+ *      g - the moves taken to reach index
+ *      stats - counters to update
  */
-static void create_neighbors(Heap next,
-                Maze maze, Traveler* curr) {
-    // mark this spot as -1 to signifiy that
-    // we have traveled to this point already
-    maze->data[curr->to_visit] = -1;
-    // enqueue sorrounding paths
-    int index = curr->to_visit;
-    if(ABOVE(index) >= 0 && !maze->data[ABOVE(index)])
-        insertHeapItem(next, 
-            create_traveler(ABOVE(index), distance(ABOVE(index)%maze->width, (int)(ABOVE(index)/maze->width), maze->width, maze->height), curr));
-    if(BELOW(index) >= 0 && !maze->data[BELOW(index)])
-        insertHeapItem(next, 
-            create_traveler(BELOW(index), distance(BELOW(index)%maze->width, (int)(BELOW(index)/maze->width), maze->width, maze->height), curr));
-    if(LEFT(index) >= 0 && !maze->data[LEFT(index)])
-        insertHeapItem(next, 
-            create_traveler(LEFT(index), distance(LEFT(index)%maze->width, (int)(LEFT(index)/maze->width), maze->width, maze->height), curr));
-    if(RIGHT(index) >= 0 && !maze->data[RIGHT(index)])
-        insertHeapItem(next, 
-            create_traveler(RIGHT(index), distance(RIGHT(index)%maze->width, (int)(RIGHT(index)/maze->width), maze->width, maze->height), curr));
+static void create_neighbors(PQueue next, Maze maze, Solver solver,
+                size_t index, uint64_t g, SolveStats* stats) {
+    size_t neighbors[] = {ABOVE(index), BELOW(index), LEFT(index), RIGHT(index)};
+    for(int step = STEP_UP; step <= STEP_RIGHT; step++)
+        if(OPEN(neighbors[step])) {
+            pq_push(next, priority(maze, solver, neighbors[step], g + 1), 
+                    ITEM(neighbors[step], step));
+            stats->pushed++;
+        }
+}
 
+/**
+ * exit_cut_off()
+ *      checks the labels of a labeled maze for an exit the start can't
+ *      reach, so a solve can give up before searching
+ * args -
+ *      maze - the maze about to be solved
+ * returns -
+ *      1 if the maze is labeled and has no solution, 0 otherwise
+ */
+static int exit_cut_off(const Maze maze) {
+    return maze->labels != NULL && (!maze->labels[0] || maze->labels[0] != 
+            maze->labels[(size_t)maze->width * maze->height - 1]);
 }
 
 /**
  * solve_maze()
- *      modifies the maze rows such that the 
- *      shortest path is marked with the steps to solve the maze.
+ *      marks the shortest path in the maze's solution bitmap,
+ *      any previous solution is discarded.
  *
  *      the maze is modified such that future calls
  *      to pretty_print_maze() will print VALID_PATH
- *      on the path towards the exit
+ *      on the path towards the exit, solve_maze_in()
+ *      leaves the maze unchanged
  * args - 
  *      maze - the maze to solve
  * returns -
@@ -211,47 +938,198 @@ static void create_neighbors(Heap next,
  *      or -1 if there is no solution
  */
 int solve_maze(Maze maze) {
-    Heap next = createHeap(10, cmpTravelers, dumpTraveler); // queue of nodes we have to got to
-    StackADT visited = stk_create();
+    return solve_maze_with(maze, SOLVE_BITBFS, NULL);
+}
+
+/// Implementation from mazeimpl.h
+/// prepare_search()
+///     discards the previous solution and search state of the maze
+void prepare_search(Maze maze) {
+    size_t words = maze->words;
+    // the search state of the last solve is released 
+    // all at once and its memory reused
+    memset(maze->path, 0, sizeof(uint64_t) * words);
+    if(maze->search == NULL)
+        maze->search = arena_create(sizeof(uint64_t) * (3 * words + 2) + 
+                            SEARCH_RESERVE);
+    else
+        arena_reset(maze->search);
+    maze->visited = arena_calloc(maze->search, words + 1, sizeof(uint64_t));
+    maze->steps = arena_alloc(maze->search, 
+                        sizeof(uint64_t) * (STEP_BITS * words + 1));
+}
+
+/// Implementation from mazeimpl.h
+/// trace_path()
+///     marks a path in the solution bitmap by following steps back
+int trace_path(Maze maze, const uint64_t* steps, size_t index, size_t stop) {
+    int cells = 1;
+    SET_BIT(maze->path, index);
+    while(index != stop) {
+        index = PREVIOUS(index, GET_STEP(steps, index));
+        SET_BIT(maze->path, index);
+        cells++;
+    }
+    return cells;
+}
+
+/**
+ * solve_maze_with()
+ *      solve_maze() using a chosen search strategy
+ * args - 
+ *      maze - the maze to solve
+ *      solver - the search strategy
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+int solve_maze_with(Maze maze, Solver solver, SolveStats* stats) {
+    // only Dijkstra's search counts costs, and unit cost mazes
+    // are solved faster breadth first
+    if(maze->weights != NULL) solver = SOLVE_DIAL;
+    else if(solver == SOLVE_DIAL) solver = SOLVE_BITBFS;
+    if(solver == SOLVE_PARBFS) return solve_maze_parallel(maze, 0, stats);
+    // the word parallel solvers move whole rows of words at once,
+    // which only line up in the row major layout
+    if(maze->tiled && (solver == SOLVE_JPS || solver == SOLVE_BITBFS))
+        solver = SOLVE_BIBFS;
+    SolveStats counts = {0, 0};
+    // forget any previous solution
+    prepare_search(maze);
+    if(stats == NULL) stats = &counts;
+    *stats = counts;
+    if(!maze->width || !maze->height || exit_cut_off(maze)) return -1;
+    if(solver == SOLVE_BIBFS) return solve_bibfs(maze, stats);
+    if(solver == SOLVE_JPS) return solve_jps(maze, stats);
+    if(solver == SOLVE_BITBFS) return solve_bitbfs(maze, stats);
+    if(solver == SOLVE_DIAL) return solve_dial(maze, stats);
+
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    // queue of spaces we have to got to
+    PQueue next = pq_create_in(maze->search, SEARCH_RESERVE / 16);
     // Create the startpoint for the maze
-    insertHeapItem(next, create_traveler(0, distance(0,0,maze->width, maze->height), NULL));
+    pq_push(next, priority(maze, solver, 0, 0), ITEM(0, STEP_UP));
+    stats->pushed++;
     
     // we want to exit this loop if there is nowhere left
     // to travel or we found the exit
     int foundExit = 0;
-    Traveler* curr = NULL; 
-    while(sizeHeap(next) && !foundExit) {
-        curr = (Traveler*)removeTopHeap(next);
+    while(!pq_empty(next) && !foundExit) {
+        uint64_t rank;
+        uint64_t item = pq_pop(next, &rank);
+        size_t index = ITEM_CELL(item);
         // we only want to look at points that have not been
         // visited or are not walls
-        if(!maze->data[curr->to_visit]) {
-            if(curr->to_visit == maze->height*maze->width - 1) {
-                maze->data[maze->width*maze->height - 1]  = curr->distance;
+        if(OPEN(index)) {
+            // set the visited bit to signifiy that
+            // we have traveled to this point already
+            SET_BIT(maze->visited, index);
+            SET_STEP(maze->steps, index, ITEM_STEP(item));
+            stats->expanded++;
+            if(index == exit)
                 foundExit = 1;
-            } else {
-                create_neighbors(next, maze, curr);
-            }   
+            else
+                create_neighbors(next, maze, solver, index, 
+                        cost(maze, solver, index, rank), stats);
+        } else {
+            STAT_ADD(STAT_STALE_POPS, 1);
         }
-        //free(curr);
-        stk_push(visited, curr);
     }
     
-    if(foundExit) {
-    int distance = 2;
-        do {
-            maze->data[curr->to_visit] = distance++;
-            curr = curr->prev;
-        } while(curr != NULL);
+    return (foundExit)?trace_path(maze, maze->steps, exit, 0):-1;  
+}
+
+/**
+ * solve_maze_parallel()
+ *      solve_maze() with a breadth first search split across threads
+ * args - 
+ *      maze - the maze to solve
+ *      threads - the amount of threads to use, below 1 for one per processor
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_maze_parallel(Maze maze, int threads, SolveStats* stats) {
+    SolveStats counts = {0, 0};
+    // forget any previous solution
+    prepare_search(maze);
+    if(stats == NULL) stats = &counts;
+    *stats = counts;
+    if(!maze->width || !maze->height || exit_cut_off(maze)) return -1;
+    if(maze->weights != NULL) return solve_dial(maze, stats);
+    if(maze->tiled) return solve_bibfs(maze, stats);
+    return solve_parbfs(maze, threads, stats);
+}
+
+/// Implementation from maze.h
+/// workspace_create()
+///     makes an empty workspace
+Workspace workspace_create(void) {
+    Workspace work = calloc(1, sizeof(struct WORKSPACE_ST));
+    assert(work != NULL);
+    return work;
+}
+
+/// Implementation from maze.h
+/// workspace_destroy()
+///     free all memory held by a workspace
+void workspace_destroy(Workspace work) {
+    if(work == NULL) return;
+    arena_destroy(work->search);
+    free(work->path);
+    free(work);
+}
+
+/// Implementation from maze.h
+/// solve_maze_in()
+///     solve_maze_with() keeping the search and the path in a workspace
+int solve_maze_in(const Maze maze, Workspace work, Solver solver, 
+                SolveStats* stats) {
+    struct MAZE_ST view;
+    workspace_view(maze, work, &view);
+    int steps = solve_maze_with(&view, solver, stats);
+    workspace_keep(work, &view);
+    return steps;
+}
+
+/// Implementation from mazeimpl.h
+/// workspace_view()
+///     makes a copy of a maze whose search state and path are a workspace's
+void workspace_view(const Maze maze, Workspace work, struct MAZE_ST* view) {
+    if(work->words < maze->words) {
+        free(work->path);
+        work->path = malloc(sizeof(uint64_t) * (maze->words + 1));
+        assert(work->path != NULL);
+        work->path[maze->words] = 0;
+        work->words = maze->words;
     }
-    
-   while(!stk_empty(visited))
-       free(stk_pop(visited));
-    
-    while(sizeHeap(next)) // clear all traversal structs
-        free(removeTopHeap(next));
-    destroyHeap(next);
-    stk_destroy(visited);
+    // the solvers run on a copy of the maze whose search state is
+    // the workspace's, the cells are shared and only read
+    *view = *maze;
+    view->search = work->search;
+    view->path = work->path;
+    view->pathRoom = work->words;
+}
 
-    return (foundExit)?maze->data[0] - 1:-1;  
+/// Implementation from mazeimpl.h
+/// workspace_keep()
+///     keeps the search state made by a solve of a workspace_view()
+void workspace_keep(Workspace work, const struct MAZE_ST* view) {
+    work->search = view->search; // made by the first solve
 }
 
+/// Implementation from maze.h
+/// print_solution()
+///     pretty_print_maze() with the path found in a workspace
+void print_solution(const Maze maze, const Workspace work, FILE* output) {
+    struct MAZE_ST view = *maze;
+    // a workspace that never solved a maze this large has no path
+    uint64_t* empty = NULL;
+    if(work->words < maze->words) {
+        empty = calloc(maze->words + 1, sizeof(uint64_t));
+        assert(empty != NULL);
+    }
+    view.path = (empty != NULL)?empty:work->path;
+    pretty_print_maze(&view, output);
+    free(empty);
+}
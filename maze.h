@@ -13,19 +13,142 @@
 #define BOUND_TOP '-' /// character representing the top/bottom of the maze
 #define BOUND_SIDE '|' /// character representing the sides of the maze
 
-/// represent a maze
+/// the most cells a weighted maze may have, so the cost of any path fits an int
+#define MAX_WEIGHTED_CELLS ((size_t)1 << 27)
+
+/// represent a maze, mazes share no state so separate mazes may be
+/// created, solved and cleaned on separate threads at once. One maze
+/// may also be solved by many threads at once with solve_maze_in()
 typedef struct MAZE_ST* Maze;
 
+/// the state of a solve kept apart from the maze it solves: the search
+/// and the path it found. solve_maze_in() only reads the maze, so any
+/// amount of threads may each solve one shared maze in their own
+/// workspace, and a workspace solving maze after maze keeps its memory
+typedef struct WORKSPACE_ST* Workspace;
+
+/// search strategies understood by solve_maze_with()
+typedef enum {
+    SOLVE_GREEDY, /// expand the cell nearest the exit first, fast but
+                  /// the path found is not always the shortest
+    SOLVE_ASTAR,  /// A* with a manhattan heuristic, finds the shortest path
+    SOLVE_BIBFS,  /// breadth first from both ends meeting in the middle,
+                  /// finds the shortest path
+    SOLVE_JPS,    /// A* over jump points, skips straight runs through
+                  /// open rooms, finds the shortest path
+    SOLVE_BITBFS, /// breadth first over whole bitmap words, 64 cells
+                  /// at a time, finds the shortest path
+    SOLVE_PARBFS, /// breadth first with each level split across one
+                  /// thread per processor, finds the shortest path
+    SOLVE_DIAL    /// Dijkstra's search with a bucket queue, finds the
+                  /// cheapest path of a weighted maze. Weighted mazes
+                  /// are solved this way whatever the solver asked for,
+                  /// unit cost mazes are solved with SOLVE_BITBFS
+} Solver;
+
+/// file formats written by save_maze(), create_maze() reads either
+typedef enum {
+    MAZE_TEXT,  /// rows of 0 for open and 1 for wall separated by spaces,
+                /// 2 to 9 for open cells costing that much to move into
+    MAZE_BINARY /// a header and the wall bitmap, see mazebinary.c,
+                /// only unit cost mazes can be written
+} MazeFormat;
+
+/// how the cells of a maze are laid out in memory
+typedef enum {
+    MAZE_ROWS, /// one row after another, what create_maze() returns
+    MAZE_TILES /// 64 by 64 cell tiles, so moving up or down stays nearby
+               /// in memory on very wide mazes
+} MazeLayout;
+
+/// a cell of a maze
+typedef struct {
+    int row;
+    int column;
+} MazeCell;
+
+/// the distance from every cell of a maze to one goal, made once so the
+/// shortest path from any start is walked without searching again.
+/// A field holds its own copy of what it needs, the maze may change
+/// layout or be cleaned while the field is in use
+typedef struct FIELD_ST* DistanceField;
+
+/// counters describing the work done by a solve
+typedef struct {
+    unsigned long expanded; /// cells taken from the queue and expanded
+    unsigned long pushed; /// cells added to the queue
+} SolveStats;
+
 /**
  * create_maze()
  *      create a maze structure from input
  * args -
  *      input - input stream to get the maze from
  * returns
- *      a pointer to a maze structure
+ *      a pointer to a maze structure, NULL if a row is malformed or a
+ *      weighted maze has more than MAX_WEIGHTED_CELLS cells
  */
 Maze create_maze(FILE* input);
 
+/**
+ * reload_maze()
+ *      create_maze() into the memory of a maze that is no longer
+ *      needed, its bitmaps are reused when the new maze fits in them
+ *      so reading maze after maze only allocates for the largest
+ * args -
+ *      maze - the maze to reuse, may be NULL. It must not be used
+ *              again, the maze returned replaces it
+ *      input - input stream to get the maze from
+ * returns -
+ *      a pointer to a maze structure, NULL as create_maze()
+ */
+Maze reload_maze(Maze maze, FILE* input);
+
+/**
+ * maze_width()
+ *      reports the amount of cells in each row of the maze
+ * args -
+ *      maze - the maze to inspect
+ * returns -
+ *      the width of the maze
+ */
+int maze_width(const Maze maze);
+
+/**
+ * maze_height()
+ *      reports the amount of rows in the maze
+ * args -
+ *      maze - the maze to inspect
+ * returns -
+ *      the height of the maze
+ */
+int maze_height(const Maze maze);
+
+/**
+ * set_maze_layout()
+ *      changes how the cells of a maze are laid out in memory,
+ *      discarding any solution. Every solver runs on either layout,
+ *      SOLVE_JPS, SOLVE_BITBFS, SOLVE_PARBFS and solve_maze_parallel()
+ *      move whole words of a row at once and solve tiled mazes 
+ *      with SOLVE_BIBFS instead
+ * args -
+ *      maze - the maze to change
+ *      layout - the layout to use
+ */
+void set_maze_layout(Maze maze, MazeLayout layout);
+
+/**
+ * save_maze()
+ *      writes the maze's cells in a format create_maze() reads back
+ * args -
+ *      maze - the maze to write
+ *      output - output stream to write the maze to
+ *      format - the file format to write
+ * returns -
+ *      0 on success, -1 on a write error
+ */
+int save_maze(const Maze maze, FILE* output, MazeFormat format);
+
 /**
  * pretty_print_maze()
  *      prints the maze cleanly
@@ -37,12 +160,13 @@ void pretty_print_maze(const Maze maze, FILE* output);
 
 /**
  * solve_maze()
- *      modifies the maze rows such that the 
- *      shortest path is marked with the steps to solve the maze.
+ *      marks the shortest path in the maze's solution bitmap,
+ *      any previous solution is discarded.
  *
  *      the maze is modified such that future calls
  *      to pretty_print_maze() will print VALID_PATH
- *      on the path towards the exit
+ *      on the path towards the exit, solve_maze_in()
+ *      leaves the maze unchanged
  * args - 
  *      maze - the maze to solve
  * returns -
@@ -51,6 +175,174 @@ void pretty_print_maze(const Maze maze, FILE* output);
  */
 int solve_maze(Maze maze);
 
+/**
+ * solve_maze_with()
+ *      solve_maze() using a chosen search strategy
+ * args - 
+ *      maze - the maze to solve
+ *      solver - the search strategy
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), the cost of the path in a weighted
+ *      maze, or -1 if there is no solution
+ */
+int solve_maze_with(Maze maze, Solver solver, SolveStats* stats);
+
+/**
+ * solve_maze_parallel()
+ *      solve_maze() with a breadth first search split across threads,
+ *      the path found is as long as the one found by solve_maze().
+ *      Weighted mazes are solved with SOLVE_DIAL on the calling thread
+ * args - 
+ *      maze - the maze to solve
+ *      threads - the amount of threads to use, 
+ *              below 1 uses one per online processor
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_maze_parallel(Maze maze, int threads, SolveStats* stats);
+
+/**
+ * workspace_create()
+ *      makes an empty workspace, its memory is allocated by the first
+ *      solve and reused by every solve after
+ * returns -
+ *      the workspace
+ */
+Workspace workspace_create(void);
+
+/**
+ * workspace_destroy()
+ *      free all memory held by a workspace
+ * args -
+ *      work - the workspace to free
+ */
+void workspace_destroy(Workspace work);
+
+/**
+ * solve_maze_in()
+ *      solve_maze_with() keeping the search and the path in a workspace,
+ *      the maze is not changed. Solves in separate workspaces may run
+ *      on the same maze at once as long as nothing changes the maze,
+ *      label it before sharing it if it is to be labeled at all
+ * args - 
+ *      maze - the maze to solve
+ *      work - the workspace, any previous solution in it is discarded
+ *      solver - the search strategy, SOLVE_PARBFS uses one thread per
+ *              online processor
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+int solve_maze_in(const Maze maze, Workspace work, Solver solver, 
+                SolveStats* stats);
+
+/**
+ * print_solution()
+ *      pretty_print_maze() with the path found by the last solve in a
+ *      workspace instead of the maze's own
+ * args-
+ *      maze - the maze the workspace last solved
+ *      work - the workspace holding the path
+ *      output - output stream to print the maze to
+ */
+void print_solution(const Maze maze, const Workspace work, FILE* output);
+
+/**
+ * label_maze()
+ *      finds which open cells of a maze are connected to each other, 
+ *      the labels are kept with the maze so later questions about it are
+ *      answered in constant time and solves of a maze with no solution
+ *      return at once. Labels of a maze whose cells change are dropped
+ * args -
+ *      maze - the maze to label
+ * returns -
+ *      the amount of separate regions of open cells
+ */
+size_t label_maze(Maze maze);
+
+/**
+ * maze_connected()
+ *      checks whether there is a path between two cells, labeling
+ *      the maze first if it is not yet labeled
+ * args -
+ *      maze - the maze
+ *      fromRow, fromColumn - one cell
+ *      toRow, toColumn - the other cell
+ * returns -
+ *      1 if both cells are open and a path joins them, 0 otherwise
+ */
+int maze_connected(const Maze maze, int fromRow, int fromColumn,
+                int toRow, int toColumn);
+
+/**
+ * field_create()
+ *      finds the distance from every cell of a maze to a goal with
+ *      one breadth first search, the maze itself is not changed.
+ *      Every open cell is one move, the costs of weighted cells are
+ *      not used
+ * args -
+ *      maze - the maze
+ *      goalRow, goalColumn - the cell every path ends at
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the distance field, or NULL if the goal is a wall or 
+ *      outside the maze
+ */
+DistanceField field_create(const Maze maze, int goalRow, int goalColumn,
+                SolveStats* stats);
+
+/**
+ * field_destroy()
+ *      free all memory held by a distance field
+ * args -
+ *      field - the field to free
+ */
+void field_destroy(DistanceField field);
+
+/**
+ * field_distance()
+ *      reports the length of the shortest path from a cell to the goal,
+ *      a single lookup
+ * args -
+ *      field - the distance field
+ *      row, column - the cell the path starts at
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no path
+ *      or the cell is a wall or outside the maze
+ */
+int field_distance(const DistanceField field, int row, int column);
+
+/**
+ * field_path()
+ *      lists the cells of a shortest path from a cell to the goal,
+ *      in time proportional to the length of the path
+ * args -
+ *      field - the distance field
+ *      row, column - the cell the path starts at
+ *      path - location to store the cells, starting cell first
+ *      room - the amount of cells path can hold, a longer path is cut
+ *              short after room cells
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no path
+ */
+int field_path(const DistanceField field, int row, int column,
+                MazeCell* path, size_t room);
+
+/**
+ * field_solve()
+ *      marks a shortest path from a cell to the goal in the solution 
+ *      bitmap of the maze the field was made from, any previous 
+ *      solution is discarded
+ * args -
+ *      field - the distance field
+ *      maze - the maze to mark the path in
+ *      row, column - the cell the path starts at
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no path
+ */
+int field_solve(const DistanceField field, Maze maze, int row, int column);
 
 /** 
  * clean_maze()
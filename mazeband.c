@@ -0,0 +1,662 @@
+/// File: mazeband.c
+/// Description: implementation of mazeband.h. The distance of every cell
+///     from the start is kept in a temporary file. A band of rows is
+///     read into memory along with its distances and those of the rows
+///     just outside it, and a breadth first search is run from the cells
+///     whose distance went down: the start, or the cells on the edges of
+///     the band that a neighboring band brought closer. A band whose edge
+///     rows changed marks its neighbors to be searched again, and sweeps
+///     alternate down and up the maze until no band is marked. The path
+///     is then walked back from the exit through the distance file and
+///     kept as bits in a second temporary file
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "mazeimpl.h"
+#include "mazeparse.h"
+#include "mazeband.h"
+
+#define NO_DISTANCE UINT32_MAX /// the distance of a cell the start can't reach
+#define READ_CHUNK (1 << 16) /// bytes of text rows read per call, at least a row
+#define HEAD_BYTES 4096 /// bytes read at once while finding the shape of a file
+
+#define BAND_CHANGED 1 /// a distance in the band went down
+#define TOP_CHANGED 2 /// a distance in the first row of the band went down
+#define BOTTOM_CHANGED 4 /// a distance in the last row of the band went down
+
+/// a cell whose distance went down before its band is searched
+typedef struct {
+    uint32_t distance;
+    uint32_t cell; /// the cell in the band, row by row from 0
+} Seed;
+
+struct BAND_ST {
+    int fd; /// the maze file
+    int binary; /// set when the file is in the binary format
+    off_t payload; /// where the first row starts in the file
+    size_t rowLength; /// bytes of one row in the file
+    size_t length; /// bytes of rows in a text file, trailing whitespace excluded
+    int width;
+    int height;
+    size_t stride; /// words per row of walls and marks
+    int rows; /// rows in a full band
+    int bands; /// the amount of bands
+    FILE* distances; /// the distance of every cell from the start plus one,
+                     /// so the zeroes of a new file are all unreached
+    FILE* path; /// set bit for every cell on the solution, stride words a row
+    int solved; /// set when path holds the solution of the last solve
+    uint64_t* walls; /// set bit for every wall in the band
+    uint64_t* marks; /// set bit for every cell of the band on the solution
+    uint32_t* distance; /// the row above the band, the band, the row below
+    uint32_t* queue; /// cells of the band waiting to be expanded
+    Seed* seeds; /// cells seeding the search of a band
+    char* text; /// rows of a text file as they were read
+    size_t textRows; /// rows text has room for
+    unsigned char* dirty; /// set for every band that has to be searched
+    size_t reads; /// bands searched by the last solve
+};
+
+/**
+ * read_at()
+ *      reads bytes from an offset of a file
+ * args -
+ *      fd - the file
+ *      buffer - where to store the bytes
+ *      bytes - the amount of bytes
+ *      offset - where in the file to start
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int read_at(int fd, void* buffer, size_t bytes, off_t offset) {
+    char* next = buffer;
+    while(bytes) {
+        ssize_t got = pread(fd, next, bytes, offset);
+        if(got <= 0) {
+            if(got < 0) perror("pread");
+            else fprintf(stderr, "maze: file is cut short\n");
+            return -1;
+        }
+        next += got;
+        bytes -= got;
+        offset += got;
+    }
+    return 0;
+}
+
+/**
+ * write_at()
+ *      writes bytes to an offset of a file
+ * args -
+ *      fd - the file
+ *      buffer - the bytes to write
+ *      bytes - the amount of bytes
+ *      offset - where in the file to start
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int write_at(int fd, const void* buffer, size_t bytes, off_t offset) {
+    const char* next = buffer;
+    while(bytes) {
+        ssize_t put = pwrite(fd, next, bytes, offset);
+        if(put < 0) {
+            perror("pwrite");
+            return -1;
+        }
+        next += put;
+        bytes -= put;
+        offset += put;
+    }
+    return 0;
+}
+
+/**
+ * clear_file()
+ *      empties a temporary file and grows it back to a size, the
+ *      file reads as zeroes without any of it being written
+ * args -
+ *      file - the file
+ *      size - the size of the file
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int clear_file(FILE* file, size_t size) {
+    if(ftruncate(fileno(file), 0) || ftruncate(fileno(file), size)) {
+        perror("ftruncate");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * text_shape()
+ *      finds the length of the rows of a text file, and the length
+ *      of the file without its trailing whitespace
+ * args -
+ *      band - the maze, its fd is read and rowLength and length set
+ *      size - the size of the file
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int text_shape(BandMaze band, size_t size) {
+    char chunk[HEAD_BYTES];
+    size_t end = size, got = 0;
+    // whitespace is trimmed a chunk at a time from the end
+    while(end) {
+        got = (end < HEAD_BYTES)?end:HEAD_BYTES;
+        if(read_at(band->fd, chunk, got, end - got)) return -1;
+        size_t kept = trim_length(chunk, got);
+        end -= got - kept;
+        if(kept) break;
+    }
+    band->length = end;
+
+    // the first row is everything before its newline
+    size_t span = 0;
+    while(span < end) {
+        got = (end - span < HEAD_BYTES)?end - span:HEAD_BYTES;
+        if(read_at(band->fd, chunk, got, span)) return -1;
+        const char* newline = memchr(chunk, '\n', got);
+        span += (newline != NULL)?(size_t)(newline - chunk):got;
+        if(newline != NULL) break;
+    }
+    band->rowLength = (span % 2)?span + 1:span;
+    if(end && !band->rowLength) {
+        report_row_error(chunk, got, 0, 0, 0);
+        return -1;
+    }
+    size_t height = (end)?(end + band->rowLength - 1) / band->rowLength:0;
+    if(band->rowLength / 2 > INT_MAX || height > INT_MAX) {
+        fprintf(stderr, "maze: the maze is too large\n");
+        return -1;
+    }
+    band->width = band->rowLength / 2;
+    band->height = height;
+    return 0;
+}
+
+/**
+ * load_walls()
+ *      reads the walls of a band from the maze file
+ * args -
+ *      band - the maze
+ *      top - the first row to read
+ *      count - the amount of rows
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int load_walls(BandMaze band, int top, int count) {
+    size_t words = band->stride * count;
+    if(band->binary)
+        return read_at(band->fd, band->walls, sizeof(uint64_t) * words,
+                        band->payload + sizeof(uint64_t) * band->stride * top);
+    for(int row = 0; row < count; row += (int)band->textRows) {
+        size_t offset = (size_t)(top + row) * band->rowLength;
+        size_t rows = count - row;
+        if(rows > band->textRows) rows = band->textRows;
+        size_t bytes = (band->length - offset < rows * band->rowLength)?
+                        band->length - offset:rows * band->rowLength;
+        if(read_at(band->fd, band->text, bytes, offset)) return -1;
+        for(size_t r = 0; r < rows; r++) {
+            const char* text = band->text + r * band->rowLength;
+            size_t available = bytes - r * band->rowLength;
+            if(available > band->rowLength) available = band->rowLength;
+            size_t bad = parse_row(text, available, band->width,
+                            band->walls + (row + r) * band->stride);
+            if(bad != PARSE_OK && bad % 2 == 0 && bad < available &&
+                    text[bad] > '1' && text[bad] <= '0' + MAX_WEIGHT) {
+                fprintf(stderr, "maze: row %zu has weighted cells, only "
+                        "unit cost mazes are solved in bands\n", 
+                        top + row + r + 1);
+                return -1;
+            } else if(bad != PARSE_OK) {
+                report_row_error(text, available, bad, top + row + r,
+                                band->width);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * load_distances()
+ *      reads the distances of rows from the distance file, rows
+ *      outside the maze are unreached
+ * args -
+ *      band - the maze
+ *      top - the first row to read
+ *      count - the amount of rows
+ *      distance - where to store the distances
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int load_distances(BandMaze band, int top, int count,
+                uint32_t* distance) {
+    size_t cells = (size_t)count * band->width;
+    if(top < 0 || top >= band->height) {
+        for(size_t cell = 0; cell < cells; cell++)
+            distance[cell] = NO_DISTANCE;
+        return 0;
+    }
+    if(read_at(fileno(band->distances), distance, sizeof(uint32_t) * cells,
+                sizeof(uint32_t) * band->width * (off_t)top))
+        return -1;
+    // 0 wraps around to NO_DISTANCE
+    for(size_t cell = 0; cell < cells; cell++)
+        distance[cell]--;
+    return 0;
+}
+
+/**
+ * store_distances()
+ *      writes the distances of rows to the distance file,
+ *      the distances are left changed
+ * args -
+ *      band - the maze
+ *      top - the first row to write
+ *      count - the amount of rows
+ *      distance - the distances
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int store_distances(BandMaze band, int top, int count,
+                uint32_t* distance) {
+    size_t cells = (size_t)count * band->width;
+    for(size_t cell = 0; cell < cells; cell++)
+        distance[cell]++;
+    return write_at(fileno(band->distances), distance,
+                    sizeof(uint32_t) * cells,
+                    sizeof(uint32_t) * band->width * (off_t)top);
+}
+
+/**
+ * compare_seeds()
+ *      orders seeds by distance for qsort()
+ */
+static int compare_seeds(const void* lhs, const void* rhs) {
+    uint32_t left = ((const Seed*)lhs)->distance;
+    uint32_t right = ((const Seed*)rhs)->distance;
+    return (left > right) - (left < right);
+}
+
+/**
+ * lower()
+ *      brings a cell of the band closer to the start
+ * args -
+ *      band - the maze
+ *      cell - the cell, row by row from the top of the band
+ *      distance - its new distance
+ *      count - the amount of rows in the band
+ * returns -
+ *      the changes made, BAND_CHANGED and the edge rows it is on
+ */
+static int lower(BandMaze band, size_t cell, uint32_t distance, int count) {
+    size_t row = cell / band->width;
+    band->distance[band->width + cell] = distance;
+    return BAND_CHANGED | ((!row)?TOP_CHANGED:0) |
+            ((row + 1 == (size_t)count)?BOTTOM_CHANGED:0);
+}
+
+/**
+ * search_band()
+ *      reads a band and lowers the distances of its cells as far as
+ *      the start and the rows next to it allow. The seeds are sorted
+ *      and the queue only ever grows in distance, so taking the closer
+ *      of the two each time expands cells in order of distance
+ * args -
+ *      band - the maze
+ *      top - the first row of the band
+ *      count - the amount of rows in the band
+ *      stats - counters to update
+ * returns -
+ *      the changes made, -1 with a message printed to stderr if the
+ *      band could not be read or written
+ */
+static int search_band(BandMaze band, int top, int count, SolveStats* stats) {
+    size_t width = band->width, cells = (size_t)count * width;
+    const uint32_t* above = band->distance;
+    uint32_t* distance = band->distance + width;
+    const uint32_t* below = distance + cells;
+    if(load_walls(band, top, count) ||
+            load_distances(band, top, count, distance) ||
+            load_distances(band, top - 1, 1, band->distance) ||
+            load_distances(band, top + count, 1, distance + cells))
+        return -1;
+
+    #define BAND_WALL(row, column) \
+        TEST_BIT(band->walls, (row) * band->stride * WORD_BITS + (column))
+    int changed = 0;
+    size_t seeds = 0;
+    if(!top && distance[0] == NO_DISTANCE && !BAND_WALL(0, 0)) {
+        changed |= lower(band, 0, 0, count);
+        band->seeds[seeds++] = (Seed){0, 0};
+    }
+    for(size_t column = 0; column < width; column++) {
+        size_t last = cells - width + column;
+        if(above[column] != NO_DISTANCE && !BAND_WALL(0, column) &&
+                above[column] + 1 < distance[column]) {
+            changed |= lower(band, column, above[column] + 1, count);
+            band->seeds[seeds++] = (Seed){distance[column], column};
+        }
+        if(below[column] != NO_DISTANCE && !BAND_WALL(count - 1, column) &&
+                below[column] + 1 < distance[last]) {
+            changed |= lower(band, last, below[column] + 1, count);
+            band->seeds[seeds++] = (Seed){distance[last], last};
+        }
+    }
+    qsort(band->seeds, seeds, sizeof(Seed), compare_seeds);
+
+    size_t next = 0, head = 0, tail = 0;
+    while(next < seeds || head < tail) {
+        size_t cell;
+        if(head < tail && (next == seeds ||
+                distance[band->queue[head]] <= band->seeds[next].distance)) {
+            cell = band->queue[head++];
+        } else {
+            cell = band->seeds[next].cell;
+            // a seed brought closer again since was queued then
+            if(distance[cell] != band->seeds[next++].distance) continue;
+        }
+        stats->expanded++;
+        size_t row = cell / width, column = cell - row * width;
+        uint32_t step = distance[cell] + 1;
+        size_t rows[] = {row - 1, row + 1, row, row};
+        size_t columns[] = {column, column, column - 1, column + 1};
+        for(int move = STEP_UP; move <= STEP_RIGHT; move++) {
+            // a step off the band wraps around past its size
+            if(rows[move] >= (size_t)count || columns[move] >= width)
+                continue;
+            size_t neighbor = rows[move] * width + columns[move];
+            if(distance[neighbor] <= step || BAND_WALL(rows[move], columns[move]))
+                continue;
+            changed |= lower(band, neighbor, step, count);
+            assert(tail < cells);
+            band->queue[tail++] = neighbor;
+            stats->pushed++;
+        }
+    }
+    #undef BAND_WALL
+
+    if((changed & BAND_CHANGED) && store_distances(band, top, count, distance))
+        return -1;
+    return changed;
+}
+
+/**
+ * move_window()
+ *      makes a band of rows around a row the one the path is being
+ *      marked in, the marks of the band before it are saved
+ * args -
+ *      band - the maze
+ *      top - the first row of the current band, -1 for none
+ *      count - the amount of rows in the current band
+ *      row - the row the new band has to hold
+ *      newTop - location to store the first row of the new band
+ * returns -
+ *      the amount of rows in the new band, -1 with a message printed
+ *      to stderr if the files could not be read or written
+ */
+static int move_window(BandMaze band, int top, int count, int row,
+                int* newTop) {
+    int fd = fileno(band->path);
+    size_t bytes = sizeof(uint64_t) * band->stride;
+    if(top >= 0 && write_at(fd, band->marks, bytes * count, bytes * top))
+        return -1;
+    // the band is centered on the row, so a path that wanders
+    // back and forth stays in it
+    top = (row > band->rows / 2)?row - band->rows / 2:0;
+    count = (band->height - top < band->rows)?band->height - top:band->rows;
+    *newTop = top;
+    if(read_at(fd, band->marks, bytes * count, bytes * top) ||
+            load_distances(band, top, count, band->distance + band->width) ||
+            load_distances(band, top - 1, 1, band->distance) ||
+            load_distances(band, top + count, 1,
+                band->distance + band->width * (count + 1)))
+        return -1;
+    return count;
+}
+
+/**
+ * trace_band()
+ *      marks the path in the path file by stepping from the exit to
+ *      a neighbor one move closer to the start until the start
+ * args -
+ *      band - the maze, solved
+ * returns -
+ *      0 on success, -1 with a message printed to stderr otherwise
+ */
+static int trace_band(BandMaze band) {
+    if(clear_file(band->path, sizeof(uint64_t) * band->stride * band->height))
+        return -1;
+    size_t width = band->width;
+    int top = -1, count = 0;
+    int row = band->height - 1, column = band->width - 1;
+    for(;;) {
+        if(row < top || row >= top + count) {
+            count = move_window(band, top, count, row, &top);
+            if(count < 0) return -1;
+        }
+        SET_BIT(band->marks, (row - top) * band->stride * WORD_BITS + column);
+        // the row above the band comes first, so row - top + 1 is
+        // the row of the window the cell is in
+        const uint32_t* here = band->distance + (row - top + 1) * width;
+        uint32_t distance = here[column];
+        if(!distance) break;
+        if((here - width)[column] == distance - 1) row--;
+        else if(here[width + column] == distance - 1) row++;
+        else if(column && here[column - 1] == distance - 1) column--;
+        else if(column + 1 < band->width && here[column + 1] == distance - 1)
+            column++;
+        else assert(0);
+    }
+    size_t bytes = sizeof(uint64_t) * band->stride;
+    return write_at(fileno(band->path), band->marks, bytes * count, bytes * top);
+}
+
+/// Implementation from mazeband.h
+/// band_open()
+///     readies a maze file to be solved in bands
+BandMaze band_open(FILE* input, size_t limit) {
+    struct stat info;
+    int fd = fileno(input);
+    if(fd < 0 || fstat(fd, &info) || !S_ISREG(info.st_mode)) {
+        fprintf(stderr, "maze: solving in bands needs a regular file\n");
+        return NULL;
+    }
+    BandMaze band = calloc(1, sizeof(struct BAND_ST));
+    assert(band != NULL);
+    band->fd = fd;
+    size_t size = info.st_size;
+    char head[HEAD_BYTES];
+    size_t got = (size < HEAD_BYTES)?size:HEAD_BYTES;
+    if(read_at(fd, head, got, 0)) {
+        free(band);
+        return NULL;
+    }
+    if(is_binary(head, got)) {
+        band->binary = 1;
+        band->payload = binary_shape(head, got, size, &band->width,
+                            &band->height);
+        if(!band->payload) {
+            free(band);
+            return NULL;
+        }
+    } else if(text_shape(band, size)) {
+        free(band);
+        return NULL;
+    }
+    size_t width = band->width, height = band->height;
+    band->stride = (width + WORD_BITS - 1) / WORD_BITS;
+    if(band->binary) band->rowLength = sizeof(uint64_t) * band->stride;
+
+    // the rows of a band hold their walls, marks, distances, queue and
+    // text, the rest is the rows next to the band, the seeds and a flag
+    // for each band
+    size_t text = (band->binary)?0:band->rowLength;
+    size_t fixed = sizeof(uint32_t) * 2 * width +
+            sizeof(Seed) * (2 * width + 1);
+    size_t perRow = sizeof(uint64_t) * 2 * band->stride +
+            sizeof(uint32_t) * 2 * width + text;
+    size_t rows = height;
+    if(perRow) rows = (limit > fixed)?(limit - fixed) / perRow:0;
+    if(rows > height) rows = height;
+    if(width && rows > (UINT32_MAX - 1) / width) rows = (UINT32_MAX - 1) / width;
+    while(rows && fixed + rows * perRow + (height + rows - 1) / rows > limit)
+        rows--;
+    if(!rows && height) {
+        fprintf(stderr, "maze: a memory limit of %zu bytes can't hold a "
+                "row, %zu bytes are needed\n", limit, fixed + perRow + height);
+        free(band);
+        return NULL;
+    }
+    band->rows = rows;
+    // text is read READ_CHUNK bytes at a time when the band holds as much
+    band->textRows = (!text)?0:(text < READ_CHUNK)?READ_CHUNK / text:1;
+    if(band->textRows > rows) band->textRows = rows;
+    band->bands = (rows)?(height + rows - 1) / rows:0;
+
+    band->distances = tmpfile();
+    band->path = tmpfile();
+    if(band->distances == NULL || band->path == NULL) {
+        perror("tmpfile");
+        band_close(band);
+        return NULL;
+    }
+    band->walls = malloc(sizeof(uint64_t) * (band->stride * rows + 1));
+    band->marks = calloc(band->stride * rows + 1, sizeof(uint64_t));
+    band->distance = malloc(sizeof(uint32_t) * (width * (rows + 2) + 1));
+    band->queue = malloc(sizeof(uint32_t) * (width * rows + 1));
+    band->seeds = malloc(sizeof(Seed) * (2 * width + 1));
+    band->text = malloc(band->textRows * band->rowLength + 1);
+    band->dirty = calloc(band->bands + 1, 1);
+    assert(band->walls != NULL && band->marks != NULL &&
+            band->distance != NULL && band->queue != NULL &&
+            band->seeds != NULL && band->text != NULL && band->dirty != NULL);
+    return band;
+}
+
+/// Implementation from mazeband.h
+/// band_close()
+///     free all memory and temporary files held by a maze
+void band_close(BandMaze band) {
+    if(band == NULL) return;
+    if(band->distances != NULL) fclose(band->distances);
+    if(band->path != NULL) fclose(band->path);
+    free(band->walls);
+    free(band->marks);
+    free(band->distance);
+    free(band->queue);
+    free(band->seeds);
+    free(band->text);
+    free(band->dirty);
+    free(band);
+}
+
+/// Implementation from mazeband.h
+/// band_width()
+///     reports the amount of cells in each row of the maze
+int band_width(const BandMaze band) {
+    return band->width;
+}
+
+/// Implementation from mazeband.h
+/// band_height()
+///     reports the amount of rows in the maze
+int band_height(const BandMaze band) {
+    return band->height;
+}
+
+/// Implementation from mazeband.h
+/// band_solve()
+///     finds the shortest path from the top left to the bottom right
+int band_solve(BandMaze band, SolveStats* stats) {
+    SolveStats counts = {0, 0};
+    if(stats == NULL) stats = &counts;
+    *stats = counts;
+    band->solved = 0;
+    band->reads = 0;
+    if(!band->width || !band->height) return -1;
+    if(clear_file(band->distances,
+                sizeof(uint32_t) * band->width * (size_t)band->height))
+        return BAND_FAILED;
+
+    band->dirty[0] = 1;
+    for(int swept = 1, down = 1; swept; down = !down) {
+        swept = 0;
+        for(int n = 0; n < band->bands; n++) {
+            int b = (down)?n:band->bands - 1 - n;
+            if(!band->dirty[b]) continue;
+            band->dirty[b] = 0;
+            swept = 1;
+            int top = b * band->rows;
+            int count = (band->height - top < band->rows)?band->height - top:
+                            band->rows;
+            int changed = search_band(band, top, count, stats);
+            band->reads++;
+            if(changed < 0) return BAND_FAILED;
+            if((changed & TOP_CHANGED) && b) band->dirty[b - 1] = 1;
+            if((changed & BOTTOM_CHANGED) && b + 1 < band->bands)
+                band->dirty[b + 1] = 1;
+        }
+    }
+
+    uint32_t exit;
+    if(load_distances(band, band->height - 1, 1, band->distance))
+        return BAND_FAILED;
+    exit = band->distance[band->width - 1];
+    if(exit == NO_DISTANCE) return -1;
+    if(trace_band(band)) return BAND_FAILED;
+    band->solved = 1;
+    return (int)exit + 1;
+}
+
+/// Implementation from mazeband.h
+/// band_reads()
+///     reports the amount of bands the last band_solve() searched
+size_t band_reads(const BandMaze band) {
+    return band->reads;
+}
+
+/// Implementation from mazeband.h
+/// band_print()
+///     prints the maze band by band
+int band_print(BandMaze band, FILE* output) {
+    // a maze over the band's buffers, so it prints like any other
+    struct MAZE_ST view;
+    memset(&view, 0, sizeof(struct MAZE_ST));
+    view.walls = band->walls;
+    view.path = band->marks;
+    view.width = band->width;
+    view.stride = band->stride;
+    view.pitch = band->stride * WORD_BITS;
+    if(!band->height) {
+        print_band(&view, 0, 0, output);
+        return 0;
+    }
+    size_t bytes = sizeof(uint64_t) * band->stride;
+    for(int top = 0; top < band->height; top += band->rows) {
+        int count = (band->height - top < band->rows)?band->height - top:
+                        band->rows;
+        if(load_walls(band, top, count)) return -1;
+        if(!band->solved)
+            memset(band->marks, 0, bytes * count);
+        else if(read_at(fileno(band->path), band->marks, bytes * count,
+                    bytes * top))
+            return -1;
+        view.height = count;
+        view.words = band->stride * count;
+        print_band(&view, top, band->height, output);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/// File: mazeband.h
+/// Description: solving mazes too large to load. The maze file is read
+///     a band of rows at a time and the state of the search is kept in
+///     temporary files, so the memory used stays under a chosen limit
+///     however large the maze is.
+///
+///     the I/O is not bounded by the size of the file alone. A band is
+///     searched again each time the search comes back into it, so every
+///     time the shortest paths turn from going down the maze to going up
+///     it, or back, costs another pass over the bands between. A path
+///     crossing each band once takes one or two passes, a corridor
+///     winding down and up every other column, GEN_COLUMNS, takes one
+///     pass for each column it winds through. mopbench band measures it
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <sys/types.h>
+#include "maze.h"
+
+#ifndef MAZEBAND
+#define MAZEBAND
+
+#define BAND_FAILED -2 /// returned by band_solve() when a file can't be used
+
+/// represent a maze file read a band of rows at a time
+typedef struct BAND_ST* BandMaze;
+
+/**
+ * band_open()
+ *      readies a maze file to be solved in bands, only the size of the
+ *      maze is read. Text files are checked row by row as the bands are
+ *      read, the checksum of a binary file is not checked. Weighted
+ *      rows are reported as errors when their band is read
+ * args -
+ *      input - the maze file, text or binary, must be a regular file
+ *              and stay open until band_close()
+ *      limit - the bytes the bands and search may hold in memory
+ * returns -
+ *      the maze, or NULL with a message printed to stderr if the file
+ *      is not a maze or one row does not fit in the limit
+ */
+BandMaze band_open(FILE* input, size_t limit);
+
+/**
+ * band_close()
+ *      free all memory and temporary files held by a maze, the maze
+ *      file is left open
+ * args -
+ *      maze - the maze to free
+ */
+void band_close(BandMaze maze);
+
+/**
+ * band_width()
+ *      reports the amount of cells in each row of the maze
+ * args -
+ *      maze - the maze
+ * returns -
+ *      the width of the maze
+ */
+int band_width(const BandMaze maze);
+
+/**
+ * band_height()
+ *      reports the amount of rows in the maze
+ * args -
+ *      maze - the maze
+ * returns -
+ *      the height of the maze
+ */
+int band_height(const BandMaze maze);
+
+/**
+ * band_solve()
+ *      finds the shortest path from the top left to the bottom right
+ *      and keeps it for band_print(), any previous solution is discarded
+ * args -
+ *      maze - the maze to solve
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the shortest path distance (min: 1), -1 if there is no solution,
+ *      or BAND_FAILED with a message printed to stderr if the maze file
+ *      has a malformed row or a file could not be read or written
+ */
+int band_solve(BandMaze maze, SolveStats* stats);
+
+/**
+ * band_reads()
+ *      reports the amount of bands the last band_solve() read and
+ *      searched, each is a read of its rows of the maze file
+ * args -
+ *      maze - the maze
+ * returns -
+ *      the amount of band searches
+ */
+size_t band_reads(const BandMaze maze);
+
+/**
+ * band_print()
+ *      prints the maze band by band exactly as pretty_print_maze()
+ *      prints it, with the path of the last band_solve()
+ * args -
+ *      maze - the maze to print
+ *      output - output stream to print the maze to
+ * returns -
+ *      0 on success, -1 with a message printed to stderr if the maze
+ *      file could not be read
+ */
+int band_print(BandMaze maze, FILE* output);
+
+#endif // MAZEBAND
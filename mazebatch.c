@@ -0,0 +1,249 @@
+/// File: mazebatch.c
+/// Description: solving many maze files in one process with a pool
+///     of threads. Mazes share no state, so each worker creates, solves
+///     and cleans its own maze without locking, results are kept by 
+///     the position of their path and printed once every worker is done.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "mazebatch.h"
+
+#define PATHS_RESERVE 64 /// paths a path array has room for at first
+
+/// what became of one maze of a batch
+typedef enum {
+    BATCH_SOLVED,
+    BATCH_UNSOLVABLE,
+    BATCH_INVALID,
+    BATCH_UNREADABLE
+} Status;
+
+/// names of each Status in the output
+static const char* STATUS_NAMES[] = {
+    "solved", "unsolvable", "invalid", "unreadable"
+};
+
+/// the result of one maze of a batch
+typedef struct RESULT_ST {
+    Status status;
+    int width;
+    int height;
+    int steps; /// the path distance, or -1
+    SolveStats stats;
+} Result;
+
+/// state shared by the workers of a batch
+typedef struct BATCH_ST {
+    char* const* paths; /// the maze files to solve
+    size_t count; /// the amount of paths
+    Solver solver; /// the search strategy to solve with
+    SolveCache cache; /// solutions to reuse, may be NULL
+    Result* results; /// one result for each path
+    size_t next; /// the first path not yet taken by a worker
+} Batch;
+
+/**
+ * add_path()
+ *      appends a copy of a path to a path array, growing it when full
+ * args -
+ *      paths - the path array
+ *      count - the amount of paths in the array
+ *      capacity - the amount of paths there is room for, at least 1
+ *      path - the path to add
+ * returns -
+ *      the path array, which may have moved
+ */
+static char** add_path(char** paths, size_t* count, size_t* capacity,
+                const char* path) {
+    if(*count == *capacity) {
+        *capacity *= 2;
+        paths = realloc(paths, sizeof(char*) * *capacity);
+        if(paths == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if((paths[*count] = strdup(path)) == NULL) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    (*count)++;
+    return paths;
+}
+
+/**
+ * compare_paths()
+ *      orders paths by name for qsort()
+ */
+static int compare_paths(const void* lhs, const void* rhs) {
+    return strcmp(*(char* const*)lhs, *(char* const*)rhs);
+}
+
+/// Implementation from mazebatch.h
+/// batch_list_dir()
+///     lists the regular files of a directory, sorted by name
+char** batch_list_dir(const char* dir, size_t* count) {
+    DIR* stream = opendir(dir);
+    if(stream == NULL) {
+        perror(dir);
+        return NULL;
+    }
+    size_t capacity = PATHS_RESERVE;
+    char** paths = malloc(sizeof(char*) * capacity);
+    if(paths == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+
+    struct dirent* entry;
+    while((entry = readdir(stream)) != NULL) {
+        if(entry->d_name[0] == '.') continue;
+        size_t length = strlen(dir) + strlen(entry->d_name) + 2;
+        char* path = malloc(length);
+        if(path == NULL) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(path, length, "%s/%s", dir, entry->d_name);
+        struct stat info;
+        if(!stat(path, &info) && S_ISREG(info.st_mode))
+            paths = add_path(paths, count, &capacity, path);
+        free(path);
+    }
+    closedir(stream);
+    if(*count) qsort(paths, *count, sizeof(char*), compare_paths);
+    return paths;
+}
+
+/// Implementation from mazebatch.h
+/// batch_read_paths()
+///     reads one path per line, blank lines are skipped
+char** batch_read_paths(FILE* input, size_t* count) {
+    size_t capacity = PATHS_RESERVE;
+    char** paths = malloc(sizeof(char*) * capacity);
+    if(paths == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    *count = 0;
+    while((length = getline(&line, &size, input)) != -1) {
+        if(length && line[length - 1] == '\n') line[--length] = '\0';
+        if(length) paths = add_path(paths, count, &capacity, line);
+    }
+    free(line);
+    return paths;
+}
+
+/// Implementation from mazebatch.h
+/// batch_free_paths()
+///     frees a path array
+void batch_free_paths(char** paths, size_t count) {
+    for(size_t p = 0; p < count; p++)
+        free(paths[p]);
+    free(paths);
+}
+
+/**
+ * solve_one()
+ *      loads, solves and frees one maze of a batch
+ * args -
+ *      batch - the batch the maze is part of
+ *      which - the position of the maze's path
+ */
+static void solve_one(Batch* batch, size_t which) {
+    Result* result = &batch->results[which];
+    FILE* input = fopen(batch->paths[which], "r");
+    if(input == NULL) {
+        perror(batch->paths[which]);
+        result->status = BATCH_UNREADABLE;
+        return;
+    }
+    Maze maze = create_maze(input);
+    fclose(input);
+    if(maze == NULL) {
+        fprintf(stderr, "%s: not a valid maze\n", batch->paths[which]);
+        result->status = BATCH_INVALID;
+        return;
+    }
+    result->width = maze_width(maze);
+    result->height = maze_height(maze);
+    result->steps = (batch->cache != NULL)?
+        cache_solve(batch->cache, maze, batch->solver, &result->stats):
+        solve_maze_with(maze, batch->solver, &result->stats);
+    result->status = (result->steps > 0)?BATCH_SOLVED:BATCH_UNSOLVABLE;
+    clean_maze(maze);
+}
+
+/**
+ * run_worker()
+ *      solves mazes of a batch until none are left
+ * args -
+ *      data - the Batch to work on
+ * returns -
+ *      NULL
+ */
+static void* run_worker(void* data) {
+    Batch* batch = data;
+    size_t which;
+    while((which = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED))
+                < batch->count)
+        solve_one(batch, which);
+    return NULL;
+}
+
+/// Implementation from mazebatch.h
+/// batch_solve()
+///     loads and solves every maze in paths on a pool of threads
+size_t batch_solve(char* const* paths, size_t count, Solver solver,
+                int threads, SolveCache cache, FILE* output) {
+    if(threads < 1) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(threads < 1) threads = 1;
+    if((size_t)threads > count) threads = (count)?(int)count:1;
+
+    Batch batch = {paths, count, solver, cache, NULL, 0};
+    batch.results = calloc(count + 1, sizeof(Result));
+    pthread_t* pool = calloc(threads, sizeof(pthread_t));
+    if(batch.results == NULL || pool == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    // the calling thread works too, so a pool that fails to 
+    // start only makes the batch slower
+    int started = 1;
+    for(; started < threads; started++)
+        if(pthread_create(&pool[started], NULL, run_worker, &batch)) {
+            perror("pthread_create");
+            break;
+        }
+    run_worker(&batch);
+    for(int t = 1; t < started; t++)
+        pthread_join(pool[t], NULL);
+
+    size_t failed = 0;
+    fprintf(output, "file,status,width,height,steps,expanded,pushed\n");
+    for(size_t p = 0; p < count; p++) {
+        const Result* result = &batch.results[p];
+        if(result->status >= BATCH_INVALID) failed++;
+        fprintf(output, "%s,%s,%i,%i,%i,%lu,%lu\n", paths[p],
+                STATUS_NAMES[result->status], result->width, result->height,
+                (result->status == BATCH_SOLVED)?result->steps:-1,
+                result->stats.expanded, result->stats.pushed);
+    }
+    free(pool);
+    free(batch.results);
+    return failed;
+}
@@ -0,0 +1,70 @@
+/// File: mazebatch.h
+/// Description: solving many maze files in one process with a pool
+///     of threads, each maze is loaded, solved and freed by one worker
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <sys/types.h>
+#include "maze.h"
+#include "mazecache.h"
+
+#ifndef MAZEBATCH
+#define MAZEBATCH
+
+/**
+ * batch_list_dir()
+ *      lists the regular files of a directory, sorted by name
+ *      so batches over the same directory are reported in the same order,
+ *      names starting with '.' are skipped
+ * args -
+ *      dir - the directory to list
+ *      count - location to store the amount of paths
+ * returns -
+ *      an array of count paths, each prefixed with dir,
+ *      or NULL if the directory could not be read
+ */
+char** batch_list_dir(const char* dir, size_t* count);
+
+/**
+ * batch_read_paths()
+ *      reads one path per line, blank lines are skipped
+ * args -
+ *      input - the stream to read paths from
+ *      count - location to store the amount of paths
+ * returns -
+ *      an array of count paths in the order they were read
+ */
+char** batch_read_paths(FILE* input, size_t* count);
+
+/**
+ * batch_free_paths()
+ *      frees a path array from batch_list_dir() or batch_read_paths()
+ * args -
+ *      paths - the paths to free
+ *      count - the amount of paths
+ */
+void batch_free_paths(char** paths, size_t count);
+
+/**
+ * batch_solve()
+ *      loads and solves every maze in paths on a pool of threads,
+ *      then prints one CSV row per path in the order of paths:
+ *          file,status,width,height,steps,expanded,pushed
+ *      status is one of solved, unsolvable, invalid (malformed maze)
+ *      or unreadable (the file could not be opened), steps is -1 when
+ *      there is no solution, columns a status has no value for are 0
+ * args -
+ *      paths - the maze files to solve
+ *      count - the amount of paths
+ *      solver - the search strategy to solve with
+ *      threads - the amount of workers, below 1 uses one per processor
+ *      cache - solutions to reuse and add to, may be NULL
+ *      output - where to print the results
+ * returns -
+ *      the amount of mazes that were invalid or unreadable
+ */
+size_t batch_solve(char* const* paths, size_t count, Solver solver,
+                int threads, SolveCache cache, FILE* output);
+
+#endif // MAZEBATCH
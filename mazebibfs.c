@@ -0,0 +1,126 @@
+/// File: mazebibfs.c
+/// Description: bidirectional breadth first search, one search grows 
+///     from the start and another from the exit, always expanding
+///     whichever frontier is smaller, until the two touch
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+#define FRONTIER_RESERVE 1024 /// cells a frontier has room for at first
+
+/// the cells found at one distance from where a side started
+typedef struct FRONTIER_ST {
+    size_t* cells; /// the cells in the level
+    size_t num; /// the amount of cells in the level
+    size_t capacity; /// the amount of cells there is room for
+} Frontier;
+
+/// the state of the search from one end of the maze
+typedef struct SIDE_ST {
+    uint64_t* visited; /// set bit for every cell this side has reached
+    uint64_t* steps; /// the step this side took into each reached cell
+    Frontier current; /// the level being expanded
+    Frontier next; /// the level being found
+} Side;
+
+/**
+ * frontier_add()
+ *      add a cell to a frontier, growing it from the arena when full
+ * args -
+ *      arena - where the frontier's memory comes from
+ *      frontier - the frontier to add to
+ *      index - the cell to add
+ */
+static void frontier_add(Arena arena, Frontier* frontier, size_t index) {
+    if(frontier->num == frontier->capacity) {
+        // the old cells are released with the arena
+        size_t capacity = (frontier->capacity)?frontier->capacity * 2:
+                                FRONTIER_RESERVE;
+        size_t* cells = arena_alloc(arena, sizeof(size_t) * capacity);
+        if(frontier->num)
+            memcpy(cells, frontier->cells, sizeof(size_t) * frontier->num);
+        frontier->cells = cells;
+        frontier->capacity = capacity;
+    }
+    frontier->cells[frontier->num++] = index;
+}
+
+/**
+ * expand_level()
+ *      move one side of the search a full level forward
+ * args -
+ *      maze - the maze being solved
+ *      side - the side to expand
+ *      other - the opposite side
+ *      stats - counters to update
+ * returns -
+ *      the first cell reached by both sides, or NO_CELL
+ */
+static size_t expand_level(Maze maze, Side* side, const Side* other,
+                SolveStats* stats) {
+    side->next.num = 0;
+    for(size_t c = 0; c < side->current.num; c++) {
+        size_t index = side->current.cells[c];
+        size_t neighbors[] = {ABOVE(index), BELOW(index), 
+                                LEFT(index), RIGHT(index)};
+        stats->expanded++;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            size_t neighbor = neighbors[step];
+            if(!OPEN_IN(side->visited, neighbor)) continue;
+            SET_BIT(side->visited, neighbor);
+            SET_STEP(side->steps, neighbor, step);
+            frontier_add(maze->search, &side->next, neighbor);
+            stats->pushed++;
+            // every cell the other side reached is at most one level 
+            // behind its frontier, so the first meeting is a shortest one
+            if(TEST_BIT(other->visited, neighbor)) return neighbor;
+        }
+    }
+    Frontier done = side->current;
+    side->current = side->next;
+    side->next = done;
+    return NO_CELL;
+}
+
+/// Implementation from mazeimpl.h
+/// solve_bibfs()
+///     breadth first search from the start and the exit at once
+int solve_bibfs(Maze maze, SolveStats* stats) {
+    size_t words = maze->words;
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    if(TEST_BIT(maze->walls, 0) || TEST_BIT(maze->walls, exit)) return -1;
+
+    Side forward, backward;
+    memset(&forward, 0, sizeof(Side));
+    memset(&backward, 0, sizeof(Side));
+    forward.visited = maze->visited;
+    forward.steps = maze->steps;
+    backward.visited = arena_calloc(maze->search, words + 1, sizeof(uint64_t));
+    backward.steps = arena_alloc(maze->search, 
+                        sizeof(uint64_t) * (STEP_BITS * words + 1));
+
+    SET_BIT(forward.visited, 0);
+    frontier_add(maze->search, &forward.current, 0);
+    SET_BIT(backward.visited, exit);
+    frontier_add(maze->search, &backward.current, exit);
+    stats->pushed += 2;
+    if(exit == 0) return trace_path(maze, forward.steps, 0, 0);
+
+    size_t meet = NO_CELL;
+    while(meet == NO_CELL && forward.current.num && backward.current.num) {
+        if(forward.current.num <= backward.current.num)
+            meet = expand_level(maze, &forward, &backward, stats);
+        else
+            meet = expand_level(maze, &backward, &forward, stats);
+    }
+    if(meet == NO_CELL) return -1;
+
+    // the meeting cell is on both halves of the path
+    return trace_path(maze, forward.steps, meet, 0) + 
+            trace_path(maze, backward.steps, meet, exit) - 1;
+}
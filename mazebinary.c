@@ -0,0 +1,213 @@
+/// File: mazebinary.c
+/// Description: the binary maze format, a 64 byte header followed by
+///     the wall bitmap exactly as a Maze holds it, so a mapped file is
+///     used in place with no decoding. All fields are little endian.
+///
+///     offset  size  field
+///          0     8  magic, BINARY_MAGIC
+///          8     4  version, BINARY_VERSION
+///         12     4  flags, reserved and 0
+///         16     4  width, cells per row
+///         20     4  height, the amount of rows
+///         24     8  stride, 64 bit words per row, (width + 63) / 64
+///         32     8  checksum, hash_words() of the payload with seed 0
+///         40    24  reserved and 0
+///         64        payload, stride * height words, one bit per cell
+///                   with walls set, the bits past width of each row clear
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the binary maze format is read in place, which needs a little endian host"
+#endif
+
+#define BINARY_MAGIC "MZBN\r\n\032\n" /// a newline or EOF mangled file won't match
+#define MAGIC_LENGTH 8 /// the length of BINARY_MAGIC
+#define BINARY_VERSION 1 /// the version written by write_binary()
+
+/// the header of a binary maze file
+typedef struct BINARY_HEADER_ST {
+    char magic[MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint64_t stride;
+    uint64_t checksum;
+    uint8_t reserved[24];
+} Header;
+
+/**
+ * check_header()
+ *      validates a header against the size of the file it came from
+ * args -
+ *      header - the header
+ *      size - the size of the file
+ * returns -
+ *      1 if the header is valid, 0 with a message printed to stderr if not
+ */
+static int check_header(const Header* header, size_t size) {
+    size_t words = (size_t)header->stride * header->height;
+    if(header->version != BINARY_VERSION) {
+        fprintf(stderr, "maze: binary version %u is not supported\n",
+                header->version);
+    } else if(header->flags) {
+        fprintf(stderr, "maze: unknown binary flags 0x%x\n", header->flags);
+    } else if(header->width > INT_MAX || header->height > INT_MAX ||
+            header->stride != (header->width + WORD_BITS - 1) / WORD_BITS ||
+            (header->height && words / header->height != header->stride)) {
+        fprintf(stderr, "maze: binary header has a bad size\n");
+    } else if((size - sizeof(Header)) / sizeof(uint64_t) < words) {
+        fprintf(stderr, "maze: binary payload is cut short, expected %zu bytes\n",
+                words * sizeof(uint64_t));
+    } else {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * check_payload()
+ *      validates the payload of a binary maze
+ * args -
+ *      header - the header of the file
+ *      walls - the payload
+ * returns -
+ *      1 if the payload is valid, 0 with a message printed to stderr if not
+ */
+static int check_payload(const Header* header, const uint64_t* walls) {
+    size_t words = (size_t)header->stride * header->height;
+    if(hash_words(walls, words, 0) != header->checksum) {
+        fprintf(stderr, "maze: binary checksum does not match\n");
+        return 0;
+    }
+    if(header->width % WORD_BITS == 0) return 1;
+    // cells past the width would be taken as part of the maze
+    uint64_t padding = ~(((uint64_t)1 << (header->width % WORD_BITS)) - 1);
+    for(size_t row = 0; row < header->height; row++)
+        if(walls[(row + 1) * header->stride - 1] & padding) {
+            fprintf(stderr, "maze: binary row %zu has cells past its width\n",
+                    row + 1);
+            return 0;
+        }
+    return 1;
+}
+
+/// Implementation from mazeimpl.h
+/// is_binary()
+///     checks whether the start of a file is a binary maze header
+int is_binary(const char* head, size_t length) {
+    return length >= MAGIC_LENGTH && !memcmp(head, BINARY_MAGIC, MAGIC_LENGTH);
+}
+
+/// Implementation from mazeimpl.h
+/// binary_shape()
+///     reads the size of a binary maze from its header
+size_t binary_shape(const char* head, size_t length, size_t size, 
+                int* width, int* height) {
+    Header header;
+    if(length < sizeof(Header)) {
+        fprintf(stderr, "maze: binary header is cut short\n");
+        return 0;
+    }
+    memcpy(&header, head, sizeof(Header));
+    if(!check_header(&header, size)) return 0;
+    *width = header.width;
+    *height = header.height;
+    return sizeof(Header);
+}
+
+/// Implementation from mazeimpl.h
+/// map_binary()
+///     create a maze whose walls are the payload of a mapped binary file
+Maze map_binary(void* mapping, size_t size) {
+    const Header* header = mapping;
+    uint64_t* walls = (uint64_t*)((char*)mapping + sizeof(Header));
+    if(size < sizeof(Header)) {
+        fprintf(stderr, "maze: binary header is cut short\n");
+        return NULL;
+    }
+    if(!check_header(header, size) || !check_payload(header, walls))
+        return NULL;
+    return allocate_maze(header->width, header->height, walls);
+}
+
+/// Implementation from mazeimpl.h
+/// stream_binary()
+///     read a binary maze from a stream that can not be mapped
+Maze stream_binary(FILE* input, const char* head, size_t length) {
+    Header header;
+    size_t got = (length < sizeof(Header))?length:sizeof(Header);
+    memcpy(&header, head, got);
+    if(got < sizeof(Header) &&
+            fread((char*)&header + got, 1, sizeof(Header) - got, input) !=
+                sizeof(Header) - got) {
+        fprintf(stderr, "maze: binary header is cut short\n");
+        return NULL;
+    }
+    // the payload has not been read yet, so only its size is unknown
+    if(!check_header(&header, SIZE_MAX)) return NULL;
+    size_t words = (size_t)header.stride * header.height;
+
+    uint64_t* walls = malloc(sizeof(uint64_t) * (words + 1));
+    if(walls == NULL) {
+        perror("malloc");
+        return NULL;
+    }
+    size_t bytes = sizeof(uint64_t) * words;
+    size_t buffered = (length > sizeof(Header))?length - sizeof(Header):0;
+    if(buffered > bytes) buffered = bytes;
+    memcpy(walls, head + sizeof(Header), buffered);
+    if(fread((char*)walls + buffered, 1, bytes - buffered, input) !=
+                bytes - buffered) {
+        fprintf(stderr, "maze: binary payload is cut short, expected %zu bytes\n",
+                bytes);
+        free(walls);
+        return NULL;
+    }
+    if(!check_payload(&header, walls)) {
+        free(walls);
+        return NULL;
+    }
+    walls[words] = 0;
+    return allocate_maze(header.width, header.height, walls);
+}
+
+/// Implementation from mazeimpl.h
+/// write_binary()
+///     writes a maze in the binary format
+int write_binary(const Maze maze, FILE* output) {
+    if(maze->weights != NULL) {
+        fprintf(stderr, "maze: binary files have no cell costs, "
+                "write weighted mazes as text\n");
+        errno = EINVAL;
+        return -1;
+    }
+    // files are always row major
+    uint64_t* walls = (maze->tiled)?layout_walls(maze, 0, NULL):maze->walls;
+    size_t words = maze->stride * maze->height;
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, BINARY_MAGIC, MAGIC_LENGTH);
+    header.version = BINARY_VERSION;
+    header.width = maze->width;
+    header.height = maze->height;
+    header.stride = maze->stride;
+    header.checksum = hash_words(walls, words, 0);
+    int failed = fwrite(&header, sizeof(Header), 1, output) != 1 ||
+            fwrite(walls, sizeof(uint64_t), words, output) != words;
+    if(walls != maze->walls) free(walls);
+    return (failed)?-1:0;
+}
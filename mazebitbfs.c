@@ -0,0 +1,217 @@
+/// File: mazebitbfs.c
+/// Description: breadth first search over whole bitmap words.
+///     The frontier is a bitmap of the maze, each level is found by 
+///     shifting it a cell in every direction, masking out walls and 
+///     reached cells and merging the results, 64 cells per operation.
+///     The level of each cell mod 3 is kept in the step map so the 
+///     path can be traced back from the exit.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+#define LEVELS 3 /// levels told apart by the step map
+
+/// a bitmap word along with its position in the row, kept so the
+/// search never divides to find where a word sits
+typedef struct {
+    size_t at; /// the word in the bitmap
+    size_t word; /// the word in its row
+} Spot;
+
+/**
+ * spread()
+ *      moves the low 32 bits of a word to the even bits,
+ *      giving every cell of a half word its two bit field
+ * args -
+ *      bits - the bits to spread
+ * returns -
+ *      bit i of bits in bit 2i
+ */
+static uint64_t spread(uint64_t bits) {
+    bits &= 0xFFFFFFFFull;
+    bits = (bits | (bits << 16)) & 0x0000FFFF0000FFFFull;
+    bits = (bits | (bits << 8)) & 0x00FF00FF00FF00FFull;
+    bits = (bits | (bits << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    bits = (bits | (bits << 2)) & 0x3333333333333333ull;
+    bits = (bits | (bits << 1)) & 0x5555555555555555ull;
+    return bits;
+}
+
+/**
+ * store_level()
+ *      writes a level into the step map field of every cell in a word
+ * args -
+ *      steps - the step map
+ *      word - the bitmap word the cells are in
+ *      cells - the cells reached at this level
+ *      level - the level mod LEVELS
+ */
+static void store_level(uint64_t* steps, size_t word, uint64_t cells, int level) {
+    for(int half = 0; half < 2; half++) {
+        if(!(uint32_t)(cells >> (half * WORD_BITS / 2))) continue;
+        uint64_t low = spread(cells >> (half * WORD_BITS / 2));
+        uint64_t field = low | (low << 1);
+        uint64_t value = ((level & 1)?low:0) | ((level & 2)?low << 1:0);
+        uint64_t* target = &steps[STEP_BITS * word + half];
+        *target = (*target & ~field) | value;
+    }
+}
+
+/**
+ * row_mask()
+ *      the cells of a word that are inside the maze
+ * args -
+ *      maze - the maze
+ *      word - the word of a row
+ * returns -
+ *      a set bit for every column of the word before the padding
+ */
+static uint64_t row_mask(const Maze maze, size_t word) {
+    if(word + 1 < maze->stride || maze->width % WORD_BITS == 0)
+        return ~(uint64_t)0;
+    return ((uint64_t)1 << (maze->width % WORD_BITS)) - 1;
+}
+
+/**
+ * next_word()
+ *      the cells of a word reached from the frontier in one move
+ * args -
+ *      maze - the maze
+ *      frontier - the cells reached on the last level
+ *      reached - every cell reached so far
+ *      spot - the word to fill
+ * returns -
+ *      the newly reached cells of the word
+ */
+static uint64_t next_word(const Maze maze, const uint64_t* frontier,
+                const uint64_t* reached, Spot spot) {
+    size_t stride = maze->stride, at = spot.at;
+    // cells one column over take the bit carried between words
+    uint64_t cells = (frontier[at] << 1) | (frontier[at] >> 1);
+    if(spot.word > 0) cells |= frontier[at - 1] >> (WORD_BITS - 1);
+    if(spot.word + 1 < stride) cells |= frontier[at + 1] << (WORD_BITS - 1);
+    if(at >= stride) cells |= frontier[at - stride];
+    if(at + stride < maze->words) cells |= frontier[at + stride];
+    return cells & ~maze->walls[at] & ~reached[at] & row_mask(maze, spot.word);
+}
+
+/**
+ * touch()
+ *      queues a word the frontier can move into, once per level
+ * args -
+ *      queued - a bit for every word already queued
+ *      touched - the queued words
+ *      count - the amount of queued words
+ *      at - the word
+ *      word - the word in its row
+ */
+static void touch(uint64_t* queued, Spot* touched, size_t* count, 
+                size_t at, size_t word) {
+    if(TEST_BIT(queued, at)) return;
+    SET_BIT(queued, at);
+    touched[(*count)++] = (Spot){at, word};
+}
+
+/// Implementation from mazeimpl.h
+/// solve_bitbfs()
+///     breadth first search over whole bitmap words
+int solve_bitbfs(Maze maze, SolveStats* stats) {
+    size_t words = maze->words;
+    size_t stride = maze->stride;
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    if(TEST_BIT(maze->walls, 0)) return -1;
+
+    uint64_t* reached = maze->visited;
+    uint64_t* frontier = arena_calloc(maze->search, words + 1, sizeof(uint64_t));
+    uint64_t* next = arena_calloc(maze->search, words + 1, sizeof(uint64_t));
+    // only words holding frontier cells are visited, most of the 
+    // maze is either already reached or far from the frontier
+    Spot* active = arena_alloc(maze->search, sizeof(Spot) * words);
+    Spot* touched = arena_alloc(maze->search, sizeof(Spot) * words);
+    uint64_t* queued = arena_calloc(maze->search, 
+                            words / WORD_BITS + 1, sizeof(uint64_t));
+    size_t activeCount = 1;
+    active[0] = (Spot){0, 0};
+    SET_BIT(reached, 0);
+    SET_BIT(frontier, 0);
+    store_level(maze->steps, 0, 1, 0);
+    stats->pushed++;
+
+    long level = 0;
+    while(!TEST_BIT(reached, exit) && activeCount) {
+        level++;
+        // words the frontier can move into
+        size_t touchedCount = 0;
+        for(size_t a = 0; a < activeCount; a++) {
+            size_t at = active[a].at, word = active[a].word;
+            touch(queued, touched, &touchedCount, at, word);
+            if(word > 0 && (frontier[at] & 1))
+                touch(queued, touched, &touchedCount, at - 1, word - 1);
+            if(word + 1 < stride && (frontier[at] >> (WORD_BITS - 1)))
+                touch(queued, touched, &touchedCount, at + 1, word + 1);
+            if(at >= stride)
+                touch(queued, touched, &touchedCount, at - stride, word);
+            if(at + stride < words)
+                touch(queued, touched, &touchedCount, at + stride, word);
+        }
+
+        size_t nextCount = 0;
+        for(size_t t = 0; t < touchedCount; t++) {
+            size_t at = touched[t].at;
+            uint64_t cells = next_word(maze, frontier, reached, touched[t]);
+            queued[at / WORD_BITS] &= ~((uint64_t)1 << (at % WORD_BITS));
+            if(cells) {
+                next[at] = cells;
+                reached[at] |= cells;
+                store_level(maze->steps, at, cells, level % LEVELS);
+                stats->pushed += __builtin_popcountll(cells);
+                touched[nextCount++] = touched[t];
+            }
+        }
+
+        // the old frontier is cleared so the buffers can trade places
+        for(size_t a = 0; a < activeCount; a++) {
+            stats->expanded += __builtin_popcountll(frontier[active[a].at]);
+            frontier[active[a].at] = 0;
+        }
+        uint64_t* swapWords = frontier;
+        frontier = next;
+        next = swapWords;
+        Spot* swapList = active;
+        active = touched;
+        touched = swapList;
+        activeCount = nextCount;
+    }
+    if(!TEST_BIT(reached, exit)) return -1;
+
+    // neighbors on a shortest path are one level apart, and only a 
+    // cell one level back has the previous level mod 3
+    size_t index = exit, row = maze->height - 1, column = maze->width - 1;
+    SET_BIT(maze->path, index);
+    for(long at = level; at > 0; at--) {
+        int back = (at - 1) % LEVELS;
+        if(row > 0 && TEST_BIT(reached, index - maze->pitch) && 
+                GET_STEP(maze->steps, index - maze->pitch) == back) {
+            index -= maze->pitch;
+            row--;
+        } else if(row + 1 < (size_t)maze->height && 
+                TEST_BIT(reached, index + maze->pitch) &&
+                GET_STEP(maze->steps, index + maze->pitch) == back) {
+            index += maze->pitch;
+            row++;
+        } else if(column > 0 && TEST_BIT(reached, index - 1) && 
+                GET_STEP(maze->steps, index - 1) == back) {
+            index--;
+            column--;
+        } else {
+            index++;
+            column++;
+        }
+        SET_BIT(maze->path, index);
+    }
+    return level + 1;
+}
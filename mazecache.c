@@ -0,0 +1,512 @@
+/// File: mazecache.c
+/// Description: a cache of solutions keyed by a hash of the maze's grid.
+///     Solutions are kept as the moves from the start, two bits each,
+///     in a chained hash table threaded onto a least recently used list.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+#include "mazecache.h"
+
+#define CACHE_MAGIC "MZCACHE1" /// first bytes of a cache file
+#define MAGIC_LENGTH 8 /// the length of CACHE_MAGIC
+
+/// moves packed into one word of an encoded path
+#define MOVES_PER_WORD (WORD_BITS / STEP_BITS)
+/// words needed to encode a path of a given distance
+#define MOVE_WORDS(steps) (((steps) > 1)? \
+    ((size_t)(steps) - 1 + MOVES_PER_WORD - 1) / MOVES_PER_WORD:0)
+
+/// one cached solution
+typedef struct ENTRY_ST {
+    uint64_t hash; /// hash of the grid the solution is for
+    int32_t width;
+    int32_t height;
+    int32_t solver; /// the Solver that found the solution
+    int32_t steps; /// the path distance, or -1
+    uint64_t* moves; /// the step into each cell of the path after the start
+    struct ENTRY_ST* chain; /// the next entry in the same bucket
+    struct ENTRY_ST* newer; /// the entry used after this one
+    struct ENTRY_ST* older; /// the entry used before this one
+} Entry;
+
+struct CACHE_ST {
+    Entry** buckets; /// chains of entries by hash
+    size_t mask; /// buckets - 1, the bucket count is a power of two
+    size_t num; /// the amount of entries
+    size_t capacity; /// the most entries kept
+    Entry* newest; /// the most recently used entry
+    Entry* oldest; /// the least recently used entry, evicted first
+    CacheCounters counters;
+    pthread_mutex_t lock; /// held while the table or list is used
+};
+
+/**
+ * encode_path()
+ *      packs the maze's solution into moves from the start. A shortest
+ *      path never touches itself, so every cell after the start has
+ *      one way forward. Paths that touch themselves are not encoded
+ * args -
+ *      maze - the solved maze
+ *      steps - the path distance
+ *      moves - MOVE_WORDS(steps) words to store the moves in
+ * returns -
+ *      0 on success, -1 if the path could not be followed
+ */
+static int encode_path(const Maze maze, int steps, uint64_t* moves) {
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    size_t index = 0, previous = NO_CELL;
+    memset(moves, 0, sizeof(uint64_t) * MOVE_WORDS(steps));
+    for(int move = 0; move < steps - 1; move++) {
+        if(index == exit) return -1;
+        size_t neighbors[] = {ABOVE(index), BELOW(index),
+                                LEFT(index), RIGHT(index)};
+        int forward = -1;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            size_t neighbor = neighbors[step];
+            if(neighbor == NO_CELL || neighbor == previous ||
+                    !TEST_BIT(maze->path, neighbor))
+                continue;
+            if(forward >= 0) return -1;
+            forward = step;
+        }
+        if(forward < 0) return -1;
+        SET_STEP(moves, move, forward);
+        previous = index;
+        index = neighbors[forward];
+    }
+    return (index == exit)?0:-1;
+}
+
+/**
+ * decode_path()
+ *      marks an encoded path in the maze's solution bitmap
+ * args -
+ *      maze - the maze
+ *      steps - the path distance, or -1
+ *      moves - the encoded path
+ * returns -
+ *      0 on success, -1 if a move leaves the maze or enters a wall,
+ *      the path is for another grid with the same hash
+ */
+static int decode_path(Maze maze, int steps, const uint64_t* moves) {
+    if(steps < 1) return 0;
+    size_t index = 0;
+    SET_BIT(maze->path, index);
+    for(int move = 0; move < steps - 1; move++) {
+        switch(GET_STEP(moves, move)) {
+            case STEP_UP: index = ABOVE(index); break;
+            case STEP_DOWN: index = BELOW(index); break;
+            case STEP_LEFT: index = LEFT(index); break;
+            default: index = RIGHT(index); break;
+        }
+        if(index == NO_CELL || TEST_BIT(maze->walls, index)) return -1;
+        SET_BIT(maze->path, index);
+    }
+    return 0;
+}
+
+/**
+ * valid_moves()
+ *      follows an encoded path on a grid of a size without the grid
+ * args -
+ *      width - the width of the grid
+ *      height - the height of the grid
+ *      steps - the path distance, or -1
+ *      moves - the encoded path
+ * returns -
+ *      1 if every move stays on the grid and the last ends on the exit,
+ *      0 otherwise
+ */
+static int valid_moves(int32_t width, int32_t height, int32_t steps,
+                const uint64_t* moves) {
+    if(steps < 1) return steps == -1;
+    int32_t row = 0, column = 0;
+    for(int32_t move = 0; move < steps - 1; move++) {
+        switch(GET_STEP(moves, move)) {
+            case STEP_UP: row--; break;
+            case STEP_DOWN: row++; break;
+            case STEP_LEFT: column--; break;
+            default: column++; break;
+        }
+        if(row < 0 || row >= height || column < 0 || column >= width)
+            return 0;
+    }
+    return row == height - 1 && column == width - 1;
+}
+
+/**
+ * unlink_entry()
+ *      takes an entry out of the least recently used list
+ */
+static void unlink_entry(SolveCache cache, Entry* entry) {
+    if(entry->newer != NULL) entry->newer->older = entry->older;
+    else cache->newest = entry->older;
+    if(entry->older != NULL) entry->older->newer = entry->newer;
+    else cache->oldest = entry->newer;
+    entry->newer = entry->older = NULL;
+}
+
+/**
+ * push_newest()
+ *      puts an entry at the recently used end of the list
+ */
+static void push_newest(SolveCache cache, Entry* entry) {
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if(cache->newest != NULL) cache->newest->newer = entry;
+    else cache->oldest = entry;
+    cache->newest = entry;
+}
+
+/**
+ * find_entry()
+ *      looks up the solution of a grid
+ * args -
+ *      cache - the cache
+ *      key - an entry holding the hash, size and solver to find
+ * returns -
+ *      the entry, or NULL if there is none
+ */
+static Entry* find_entry(SolveCache cache, const Entry* key) {
+    Entry* entry = cache->buckets[key->hash & cache->mask];
+    while(entry != NULL && (entry->hash != key->hash ||
+                entry->width != key->width || entry->height != key->height ||
+                entry->solver != key->solver))
+        entry = entry->chain;
+    return entry;
+}
+
+/**
+ * evict_oldest()
+ *      removes and frees the least recently used entry
+ */
+static void evict_oldest(SolveCache cache) {
+    Entry* victim = cache->oldest;
+    Entry** link = &cache->buckets[victim->hash & cache->mask];
+    while(*link != victim)
+        link = &(*link)->chain;
+    *link = victim->chain;
+    unlink_entry(cache, victim);
+    free(victim->moves);
+    free(victim);
+    cache->num--;
+    cache->counters.evictions++;
+}
+
+/**
+ * insert_entry()
+ *      adds a solution as the most recently used, called with the lock
+ *      held. The cache takes ownership of the entry and its moves
+ * args -
+ *      cache - the cache
+ *      entry - the solution, freed if the grid is already cached
+ */
+static void insert_entry(SolveCache cache, Entry* entry) {
+    Entry* existing = find_entry(cache, entry);
+    if(existing != NULL) {
+        // another thread solved the same grid first
+        unlink_entry(cache, existing);
+        push_newest(cache, existing);
+        free(entry->moves);
+        free(entry);
+        return;
+    }
+    if(cache->num == cache->capacity) evict_oldest(cache);
+    Entry** bucket = &cache->buckets[entry->hash & cache->mask];
+    entry->chain = *bucket;
+    *bucket = entry;
+    push_newest(cache, entry);
+    cache->num++;
+}
+
+/**
+ * new_entry()
+ *      allocates an entry with room for the moves of its path
+ * returns -
+ *      the entry, its moves are not initialized
+ */
+static Entry* new_entry(uint64_t hash, int32_t width, int32_t height,
+                int32_t solver, int32_t steps) {
+    Entry* entry = calloc(1, sizeof(Entry));
+    size_t words = MOVE_WORDS(steps);
+    if(entry == NULL || (words &&
+            (entry->moves = malloc(sizeof(uint64_t) * words)) == NULL)) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    entry->hash = hash;
+    entry->width = width;
+    entry->height = height;
+    entry->solver = solver;
+    entry->steps = steps;
+    return entry;
+}
+
+/// Implementation from mazecache.h
+/// cache_create()
+///     create an empty cache
+SolveCache cache_create(size_t capacity) {
+    size_t buckets = 16;
+    while(buckets < capacity * 2)
+        buckets *= 2;
+    SolveCache cache = calloc(1, sizeof(struct CACHE_ST));
+    if(cache == NULL || 
+            (cache->buckets = calloc(buckets, sizeof(Entry*))) == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    cache->mask = buckets - 1;
+    cache->capacity = (capacity)?capacity:1;
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+/// Implementation from mazecache.h
+/// cache_destroy()
+///     free all memory held by a cache
+void cache_destroy(SolveCache cache) {
+    while(cache->oldest != NULL) {
+        Entry* entry = cache->oldest;
+        cache->oldest = entry->newer;
+        free(entry->moves);
+        free(entry);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+}
+
+/**
+ * search_maze()
+ *      solves a maze the cache could not answer
+ * args -
+ *      maze - the maze to solve
+ *      solver - the search strategy
+ *      threads - the threads SOLVE_PARBFS uses, below 1 uses one
+ *              per online processor
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+static int search_maze(Maze maze, Solver solver, int threads, 
+                SolveStats* stats) {
+    if(solver == SOLVE_PARBFS) 
+        return solve_maze_parallel(maze, threads, stats);
+    return solve_maze_with(maze, solver, stats);
+}
+
+/**
+ * cached_solve()
+ *      cache_solve() with the threads of a SOLVE_PARBFS search
+ * args -
+ *      cache - the cache
+ *      maze - the maze to solve
+ *      solver - the search strategy
+ *      threads - the threads SOLVE_PARBFS uses
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+static int cached_solve(SolveCache cache, Maze maze, Solver solver, 
+                int threads, SolveStats* stats) {
+    // the key only covers the walls, so weighted mazes are not cached
+    if(!maze->width || !maze->height || maze->weights != NULL)
+        return search_maze(maze, solver, threads, stats);
+    Entry key;
+    // the size and layout seed the hash so grids with the same bits differ
+    key.hash = hash_words(maze->walls, maze->words, 
+                    ((uint64_t)maze->tiled << 63) | 
+                    ((uint64_t)maze->width << 32) | (uint32_t)maze->height);
+    key.width = maze->width;
+    key.height = maze->height;
+    key.solver = solver;
+
+    pthread_mutex_lock(&cache->lock);
+    Entry* entry = find_entry(cache, &key);
+    if(entry != NULL) {
+        cache->counters.hits++;
+        unlink_entry(cache, entry);
+        push_newest(cache, entry);
+        int steps = entry->steps;
+        prepare_search(maze);
+        if(!decode_path(maze, steps, entry->moves)) {
+            pthread_mutex_unlock(&cache->lock);
+            if(stats != NULL) stats->expanded = stats->pushed = 0;
+            return steps;
+        }
+        // a different grid with the same hash is solved and not kept,
+        // the solution already cached stays
+        cache->counters.hits--;
+        cache->counters.misses++;
+        pthread_mutex_unlock(&cache->lock);
+        return search_maze(maze, solver, threads, stats);
+    }
+    cache->counters.misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    // the search runs without the lock so other mazes can be solved
+    int steps = search_maze(maze, solver, threads, stats);
+    entry = new_entry(key.hash, key.width, key.height, key.solver, steps);
+    if(steps > 0 && encode_path(maze, steps, entry->moves)) {
+        free(entry->moves);
+        free(entry);
+        return steps;
+    }
+    pthread_mutex_lock(&cache->lock);
+    insert_entry(cache, entry);
+    pthread_mutex_unlock(&cache->lock);
+    return steps;
+}
+
+/// Implementation from mazecache.h
+/// cache_solve()
+///     solve_maze_with() answered from the cache when possible
+int cache_solve(SolveCache cache, Maze maze, Solver solver, SolveStats* stats) {
+    return cached_solve(cache, maze, solver, 0, stats);
+}
+
+/// Implementation from mazecache.h
+/// cache_solve_parallel()
+///     solve_maze_parallel() answered from the cache when possible
+int cache_solve_parallel(SolveCache cache, Maze maze, int threads, 
+                SolveStats* stats) {
+    return cached_solve(cache, maze, SOLVE_PARBFS, threads, stats);
+}
+
+/// Implementation from mazecache.h
+/// cache_solve_in()
+///     solve_maze_in() answered from the cache when possible
+int cache_solve_in(SolveCache cache, const Maze maze, Workspace work, 
+                Solver solver, SolveStats* stats) {
+    struct MAZE_ST view;
+    workspace_view(maze, work, &view);
+    int steps = cached_solve(cache, &view, solver, 0, stats);
+    workspace_keep(work, &view);
+    return steps;
+}
+
+/// Implementation from mazecache.h
+/// cache_counters()
+///     reports the hit, miss and eviction counters of a cache
+void cache_counters(SolveCache cache, CacheCounters* counters) {
+    pthread_mutex_lock(&cache->lock);
+    *counters = cache->counters;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/// Implementation from mazecache.h
+/// cache_load()
+///     adds the solutions saved by cache_save() to a cache
+int cache_load(SolveCache cache, const char* path) {
+    FILE* input = fopen(path, "rb");
+    if(input == NULL) return 0;
+    char magic[MAGIC_LENGTH];
+    if(fread(magic, 1, MAGIC_LENGTH, input) != MAGIC_LENGTH ||
+            memcmp(magic, CACHE_MAGIC, MAGIC_LENGTH)) {
+        fprintf(stderr, "%s: not a maze cache\n", path);
+        fclose(input);
+        return -1;
+    }
+
+    // every entry is checked before any is kept, a damaged file
+    // adds nothing to the cache
+    SolveCache loaded = cache_create(cache->capacity);
+    const char* problem = NULL;
+    uint64_t hash;
+    int32_t fields[4];
+    while(problem == NULL && fread(&hash, sizeof(hash), 1, input) == 1) {
+        if(fread(fields, sizeof(fields), 1, input) != 1) {
+            problem = "cache file is cut short";
+            break;
+        }
+        // a path never visits a cell twice
+        if(fields[0] < 1 || fields[1] < 1 || fields[3] < -1 ||
+                (fields[3] > 0 && fields[3] / fields[0] > fields[1])) {
+            problem = "cache file has a damaged entry";
+            break;
+        }
+        Entry* entry = new_entry(hash, fields[0], fields[1],
+                                    fields[2], fields[3]);
+        size_t words = MOVE_WORDS(entry->steps);
+        if(words && fread(entry->moves, sizeof(uint64_t), words, input)
+                != words)
+            problem = "cache file is cut short";
+        else if(!valid_moves(entry->width, entry->height, entry->steps,
+                    entry->moves))
+            problem = "cache file has a path that misses the exit";
+        if(problem != NULL) {
+            free(entry->moves);
+            free(entry);
+            break;
+        }
+        insert_entry(loaded, entry);
+    }
+    fclose(input);
+    if(problem != NULL) {
+        fprintf(stderr, "%s: %s\n", path, problem);
+        cache_destroy(loaded);
+        return -1;
+    }
+
+    // the oldest go in first so the order of use is kept
+    pthread_mutex_lock(&cache->lock);
+    while(loaded->oldest != NULL) {
+        Entry* entry = loaded->oldest;
+        unlink_entry(loaded, entry);
+        entry->chain = NULL;
+        insert_entry(cache, entry);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    cache_destroy(loaded);
+    return 0;
+}
+
+/// Implementation from mazecache.h
+/// cache_save()
+///     writes every solution in a cache to a file
+int cache_save(SolveCache cache, const char* path) {
+    // written beside the old file and moved over it, so a failed
+    // save never leaves a damaged cache behind
+    size_t length = strlen(path) + 5;
+    char* temporary = malloc(length);
+    if(temporary == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(temporary, length, "%s.tmp", path);
+    FILE* output = fopen(temporary, "wb");
+    if(output == NULL) {
+        perror(temporary);
+        free(temporary);
+        return -1;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    fwrite(CACHE_MAGIC, 1, MAGIC_LENGTH, output);
+    for(Entry* entry = cache->oldest; entry != NULL; entry = entry->newer) {
+        int32_t fields[] = {entry->width, entry->height,
+                                entry->solver, entry->steps};
+        fwrite(&entry->hash, sizeof(entry->hash), 1, output);
+        fwrite(fields, sizeof(fields), 1, output);
+        if(MOVE_WORDS(entry->steps))
+            fwrite(entry->moves, sizeof(uint64_t),
+                    MOVE_WORDS(entry->steps), output);
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    int status = (fclose(output) || rename(temporary, path))?-1:0;
+    if(status) {
+        perror(path);
+        remove(temporary);
+    }
+    free(temporary);
+    return status;
+}
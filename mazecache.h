@@ -0,0 +1,131 @@
+/// File: mazecache.h
+/// Description: a cache of solutions keyed by a hash of the maze's grid,
+///     so a maze seen before is answered without searching it again
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <sys/types.h>
+#include "maze.h"
+
+#ifndef MAZECACHE
+#define MAZECACHE
+
+/// represent a solution cache
+typedef struct CACHE_ST* SolveCache;
+
+/// counters describing how a cache has been used
+typedef struct {
+    unsigned long hits; /// solves answered from the cache
+    unsigned long misses; /// solves that had to search the maze
+    unsigned long evictions; /// solutions dropped to make room
+} CacheCounters;
+
+/**
+ * cache_create()
+ *      create an empty cache
+ * args -
+ *      capacity - the most solutions kept, the least recently
+ *              used is evicted when another is added
+ * returns -
+ *      the cache
+ */
+SolveCache cache_create(size_t capacity);
+
+/**
+ * cache_destroy()
+ *      free all memory held by a cache
+ * args -
+ *      cache - the cache to free
+ */
+void cache_destroy(SolveCache cache);
+
+/**
+ * cache_solve()
+ *      solve_maze_with() answered from the cache when the same grid
+ *      was solved before with the same solver. On a hit the maze's
+ *      path is restored from the cache without searching and stats
+ *      are zeroed, on a miss the maze is solved and the result kept.
+ *
+ *      grids are told apart by a 64 bit hash of their cells and size,
+ *      weighted mazes are always solved and never kept. Safe to call 
+ *      from several threads on different mazes
+ * args -
+ *      cache - the cache
+ *      maze - the maze to solve
+ *      solver - the search strategy
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+int cache_solve(SolveCache cache, Maze maze, Solver solver, SolveStats* stats);
+
+/**
+ * cache_solve_parallel()
+ *      cache_solve() with SOLVE_PARBFS run on a chosen amount of threads,
+ *      the solution is kept for SOLVE_PARBFS whatever the thread count
+ * args -
+ *      cache - the cache
+ *      maze - the maze to solve
+ *      threads - the amount of threads to use,
+ *              below 1 uses one per online processor
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+int cache_solve_parallel(SolveCache cache, Maze maze, int threads, 
+                SolveStats* stats);
+
+/**
+ * cache_solve_in()
+ *      cache_solve() into a workspace as solve_maze_in(), the maze
+ *      is left unchanged and the path is in the workspace
+ * args -
+ *      cache - the cache
+ *      maze - the maze to solve
+ *      work - the workspace to solve in
+ *      solver - the search strategy
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no solution
+ */
+int cache_solve_in(SolveCache cache, const Maze maze, Workspace work, 
+                Solver solver, SolveStats* stats);
+
+/**
+ * cache_counters()
+ *      reports the hit, miss and eviction counters of a cache
+ * args -
+ *      cache - the cache
+ *      counters - location to store the counters
+ */
+void cache_counters(SolveCache cache, CacheCounters* counters);
+
+/**
+ * cache_load()
+ *      adds the solutions saved by cache_save() to a cache,
+ *      a missing file is treated as an empty one. Every path is
+ *      followed first and a file with a path that leaves its grid
+ *      or misses the exit adds nothing
+ * args -
+ *      cache - the cache
+ *      path - the cache file
+ * returns -
+ *      0 on success, -1 with a message printed to stderr if the file
+ *      could not be read or is not a cache
+ */
+int cache_load(SolveCache cache, const char* path);
+
+/**
+ * cache_save()
+ *      writes every solution in a cache to a file, least recently used
+ *      first so loading it restores the order. The file is in the
+ *      byte order of the machine that wrote it
+ * args -
+ *      cache - the cache
+ *      path - the cache file
+ * returns -
+ *      0 on success, -1 if the file could not be written
+ */
+int cache_save(SolveCache cache, const char* path);
+
+#endif // MAZECACHE
@@ -0,0 +1,144 @@
+/// File: mazedial.c
+/// Description: Dijkstra's search over the costs of a weighted maze with
+///     Dial's bucket queue in place of a heap. A cell costs at most the
+///     heaviest cell of the maze, so the cells waiting to be expanded are
+///     never further apart than that and heaviest + 1 buckets used in a
+///     circle hold them in order. Each bucket is a list linked through
+///     the cells themselves, a cell is queued once and moved to a
+///     cheaper bucket in constant time, with no comparisons at all
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+#include "mazeparse.h"
+
+#define NO_LINK UINT32_MAX /// the end of a bucket, and the cost of a
+                           /// cell the start can't reach
+
+/// the buckets of a search, cells are numbered row by row
+typedef struct {
+    uint32_t heads[MAX_WEIGHT + 1]; /// the first cell of each bucket
+    uint32_t count; /// the amount of buckets used
+    uint32_t* next; /// the cell after each cell in its bucket
+    uint32_t* previous; /// the cell before each cell in its bucket
+} Buckets;
+
+/**
+ * bucket_add()
+ *      puts a cell at the front of the bucket of its cost
+ * args -
+ *      buckets - the buckets
+ *      cell - the cell
+ *      cost - the cost of the cell
+ */
+static void bucket_add(Buckets* buckets, uint32_t cell, uint32_t cost) {
+    uint32_t* head = &buckets->heads[cost % buckets->count];
+    buckets->previous[cell] = NO_LINK;
+    buckets->next[cell] = *head;
+    if(*head != NO_LINK) buckets->previous[*head] = cell;
+    *head = cell;
+}
+
+/**
+ * bucket_remove()
+ *      takes a cell out of the bucket of its cost
+ * args -
+ *      buckets - the buckets
+ *      cell - the cell
+ *      cost - the cost the cell was added with
+ */
+static void bucket_remove(Buckets* buckets, uint32_t cell, uint32_t cost) {
+    uint32_t next = buckets->next[cell], previous = buckets->previous[cell];
+    if(previous != NO_LINK) buckets->next[previous] = next;
+    else buckets->heads[cost % buckets->count] = next;
+    if(next != NO_LINK) buckets->previous[next] = previous;
+}
+
+/// Implementation from mazeimpl.h
+/// solve_dial()
+///     Dijkstra's search over the costs of a weighted maze
+int solve_dial(Maze maze, SolveStats* stats) {
+    size_t width = maze->width, cells = width * maze->height;
+    // create_maze() keeps every cost, and so every cell, below NO_LINK
+    assert(maze->weights != NULL && cells <= MAX_WEIGHTED_CELLS);
+    if(TEST_BIT(maze->walls, 0)) return -1;
+    const uint8_t* weights = maze->weights;
+    uint32_t* cost = arena_alloc(maze->search, sizeof(uint32_t) * cells);
+    memset(cost, 0xff, sizeof(uint32_t) * cells);
+    Buckets buckets;
+    buckets.count = maze->heaviest + 1;
+    buckets.next = arena_alloc(maze->search, sizeof(uint32_t) * cells);
+    buckets.previous = arena_alloc(maze->search, sizeof(uint32_t) * cells);
+    for(uint32_t b = 0; b < buckets.count; b++)
+        buckets.heads[b] = NO_LINK;
+
+    // the cost of a path is every cell on it, the start included
+    uint32_t exit = cells - 1, at = weights[0];
+    size_t queued = 1;
+    cost[0] = at;
+    bucket_add(&buckets, 0, at);
+    stats->pushed++;
+    while(queued) {
+        uint32_t cell = buckets.heads[at % buckets.count];
+        if(cell == NO_LINK) {
+            at++;
+            continue;
+        }
+        bucket_remove(&buckets, cell, at);
+        queued--;
+        stats->expanded++;
+        if(cell == exit) break;
+        size_t row = cell / width, column = cell - row * width;
+        size_t rows[] = {row - 1, row + 1, row, row};
+        size_t columns[] = {column, column, column - 1, column + 1};
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            // a step off the maze wraps around past its size
+            if(rows[step] >= (size_t)maze->height || columns[step] >= width ||
+                    TEST_BIT(maze->walls, COORDS(rows[step], columns[step])))
+                continue;
+            uint32_t neighbor = rows[step] * width + columns[step];
+            uint32_t reach = at + weights[neighbor];
+            if(reach >= cost[neighbor]) continue;
+            if(cost[neighbor] != NO_LINK)
+                bucket_remove(&buckets, neighbor, cost[neighbor]);
+            else
+                queued++;
+            cost[neighbor] = reach;
+            bucket_add(&buckets, neighbor, reach);
+            stats->pushed++;
+        }
+    }
+    if(cost[exit] == NO_LINK) return -1;
+
+    // every cell but the start was reached from a neighbor
+    // costing exactly its own cost less
+    size_t row = maze->height - 1, column = width - 1;
+    uint32_t cell = exit;
+    SET_BIT(maze->path, COORDS(row, column));
+    while(cell) {
+        uint32_t want = cost[cell] - weights[cell];
+        if(row && cost[cell - width] == want) {
+            row--;
+            cell -= width;
+        } else if(row + 1 < (size_t)maze->height &&
+                cost[cell + width] == want) {
+            row++;
+            cell += width;
+        } else if(column && cost[cell - 1] == want) {
+            column--;
+            cell--;
+        } else {
+            column++;
+            cell++;
+        }
+        SET_BIT(maze->path, COORDS(row, column));
+    }
+    return (cost[exit] > INT_MAX)?INT_MAX:(int)cost[exit];
+}
@@ -0,0 +1,185 @@
+/// File: mazefield.c
+/// Description: distance fields, one breadth first search from a goal
+///     records how many moves every cell is from it. The path from any
+///     start is then found by stepping to a neighbor one move closer
+///     until the goal is reached, with no search at all
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+#define NO_DISTANCE UINT32_MAX /// the distance of a cell the goal can't reach
+
+/// the distances are kept in the layout the maze had when the field was
+/// made, so the field outlives the maze and layout changes made to it
+struct FIELD_ST {
+    struct MAZE_ST shape; /// the size and layout of the maze, no bitmaps
+    uint32_t* distance; /// the moves from every cell to the goal
+};
+
+/**
+ * field_cell()
+ *      finds a cell of the field
+ * args -
+ *      field - the field
+ *      row, column - the cell
+ * returns -
+ *      the index of the cell, or NO_CELL if it is outside the maze
+ */
+static size_t field_cell(const DistanceField field, int row, int column) {
+    const struct MAZE_ST* maze = &field->shape;
+    if(row < 0 || row >= maze->height || column < 0 || column >= maze->width)
+        return NO_CELL;
+    return COORDS(row, column);
+}
+
+/**
+ * cell_at()
+ *      finds the row and column of a cell of the field
+ * args -
+ *      field - the field
+ *      index - the cell
+ *      cell - location to store the row and column
+ */
+static void cell_at(const DistanceField field, size_t index, MazeCell* cell) {
+    const struct MAZE_ST* maze = &field->shape;
+    cell->row = (int)ROW(index);
+    cell->column = (int)COLUMN(index);
+}
+
+/**
+ * closer_cell()
+ *      finds a neighbor one move closer to the goal
+ * args -
+ *      field - the field
+ *      index - a cell the goal can reach that is not the goal
+ * returns -
+ *      the neighbor
+ */
+static size_t closer_cell(const DistanceField field, size_t index) {
+    const struct MAZE_ST* maze = &field->shape;
+    uint32_t want = field->distance[index] - 1;
+    size_t neighbors[] = {ABOVE(index), BELOW(index),
+                            LEFT(index), RIGHT(index)};
+    for(int step = STEP_UP; step < STEP_RIGHT; step++)
+        if(neighbors[step] != NO_CELL &&
+                field->distance[neighbors[step]] == want)
+            return neighbors[step];
+    // a reached cell always has a neighbor the search came from
+    return neighbors[STEP_RIGHT];
+}
+
+/// Implementation from maze.h
+/// field_create()
+///     finds the distance from every cell of a maze to a goal
+DistanceField field_create(const Maze maze, int goalRow, int goalColumn,
+                SolveStats* stats) {
+    if(goalRow < 0 || goalRow >= maze->height || goalColumn < 0 ||
+            goalColumn >= maze->width ||
+            TEST_BIT(maze->walls, COORDS(goalRow, goalColumn)))
+        return NULL;
+
+    DistanceField field = malloc(sizeof(struct FIELD_ST));
+    assert(field != NULL);
+    field->shape = *maze;
+    field->shape.walls = field->shape.path = NULL;
+    field->shape.visited = field->shape.steps = NULL;
+    field->shape.mapping = NULL;
+    field->shape.search = NULL;
+    field->shape.labels = NULL;
+    field->shape.weights = NULL;
+    size_t cells = maze->words * WORD_BITS;
+    field->distance = malloc(sizeof(uint32_t) * cells);
+    // each cell is queued at most once
+    size_t* queue = malloc(sizeof(size_t) * (size_t)maze->width * maze->height);
+    assert(field->distance != NULL && queue != NULL);
+    memset(field->distance, 0xff, sizeof(uint32_t) * cells);
+
+    SolveStats counted = {0, 1};
+    size_t head = 0, tail = 0;
+    queue[tail++] = COORDS(goalRow, goalColumn);
+    field->distance[queue[0]] = 0;
+    while(head < tail) {
+        size_t index = queue[head++];
+        uint32_t next = field->distance[index] + 1;
+        counted.expanded++;
+        size_t neighbors[] = {ABOVE(index), BELOW(index),
+                                LEFT(index), RIGHT(index)};
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            size_t neighbor = neighbors[step];
+            if(neighbor == NO_CELL || TEST_BIT(maze->walls, neighbor) ||
+                    field->distance[neighbor] != NO_DISTANCE)
+                continue;
+            field->distance[neighbor] = next;
+            queue[tail++] = neighbor;
+            counted.pushed++;
+        }
+    }
+    free(queue);
+    if(stats != NULL) *stats = counted;
+    return field;
+}
+
+/// Implementation from maze.h
+/// field_destroy()
+///     free all memory held by a distance field
+void field_destroy(DistanceField field) {
+    if(field == NULL) return;
+    free(field->distance);
+    free(field);
+}
+
+/// Implementation from maze.h
+/// field_distance()
+///     reports the length of the shortest path from a cell to the goal
+int field_distance(const DistanceField field, int row, int column) {
+    size_t index = field_cell(field, row, column);
+    if(index == NO_CELL || field->distance[index] == NO_DISTANCE) return -1;
+    return (int)field->distance[index] + 1;
+}
+
+/// Implementation from maze.h
+/// field_path()
+///     lists the cells of a shortest path from a cell to the goal
+int field_path(const DistanceField field, int row, int column,
+                MazeCell* path, size_t room) {
+    int cells = field_distance(field, row, column);
+    if(cells < 0) return -1;
+    size_t index = field_cell(field, row, column);
+    for(size_t at = 0; at < room && at < (size_t)cells; at++) {
+        cell_at(field, index, &path[at]);
+        if(at + 1 < (size_t)cells) index = closer_cell(field, index);
+    }
+    return cells;
+}
+
+/// Implementation from maze.h
+/// field_solve()
+///     marks a shortest path from a cell to the goal in a maze
+int field_solve(const DistanceField field, Maze maze, int row, int column) {
+    assert(maze->width == field->shape.width &&
+            maze->height == field->shape.height);
+    prepare_search(maze);
+    int cells = field_distance(field, row, column);
+    if(cells < 0) return -1;
+    size_t index = field_cell(field, row, column);
+    // the same index names the same cell unless the maze's layout changed
+    int same = maze->tiled == field->shape.tiled;
+    for(int at = 0; at < cells; at++) {
+        if(same) {
+            SET_BIT(maze->path, index);
+        } else {
+            MazeCell cell;
+            cell_at(field, index, &cell);
+            SET_BIT(maze->path, COORDS(cell.row, cell.column));
+        }
+        if(at + 1 < cells) index = closer_cell(field, index);
+    }
+    return cells;
+}
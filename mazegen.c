@@ -0,0 +1,203 @@
+/// File: mazegen.c
+/// Description: implementation of mazegen.h, mazes are built straight
+///     into the wall bitmap so very large ones never exist as text
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+#include "mazeparse.h"
+#include "mazegen.h"
+
+#define CLEAR_BIT(map, index) \
+    ((map)[(index) / WORD_BITS] &= ~((uint64_t)1 << ((index) % WORD_BITS)))
+
+/// the names of the families, in the order of MazeFamily
+static const char* FAMILY_NAMES[] = {
+    "perfect", "rooms", "random", "sealed", "corridor", "terrain", "columns"
+};
+
+/**
+ * next_random()
+ *      advances an xorshift generator
+ * args -
+ *      state - the generator, never 0
+ * returns -
+ *      the next random number
+ */
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * fill_walls()
+ *      makes every cell of a maze a wall, the padding past
+ *      the width of each row stays clear
+ * args -
+ *      maze - the maze
+ */
+static void fill_walls(Maze maze) {
+    uint64_t last = (maze->width % WORD_BITS)?
+        ((uint64_t)1 << (maze->width % WORD_BITS)) - 1:~(uint64_t)0;
+    for(int y = 0; y < maze->height; y++) {
+        uint64_t* row = maze->walls + y * maze->stride;
+        memset(row, 0xff, sizeof(uint64_t) * (maze->stride - 1));
+        row[maze->stride - 1] = last;
+    }
+}
+
+/**
+ * carve_perfect()
+ *      carves a perfect maze with a recursive backtracker run on an
+ *      explicit stack. The cells at even rows and columns are the rooms
+ *      of the maze, a passage is the cell between two of them
+ * args -
+ *      maze - the maze, every cell a wall
+ *      seed - the generator
+ */
+static void carve_perfect(Maze maze, uint64_t* seed) {
+    size_t across = (maze->width + 1) / 2, down = (maze->height + 1) / 2;
+    size_t capacity = 1024, depth = 0;
+    uint32_t* stack = malloc(sizeof(uint32_t) * capacity);
+    assert(stack != NULL && across * down < UINT32_MAX);
+    CLEAR_BIT(maze->walls, ROWS_COORDS(0, 0));
+    stack[depth++] = 0;
+    while(depth) {
+        uint32_t room = stack[depth - 1];
+        int y = (int)(room / across) * 2, x = (int)(room % across) * 2;
+        // the rooms next to this one that are still walled in
+        int rows[] = {y - 2, y + 2, y, y}, columns[] = {x, x, x - 2, x + 2};
+        int choices[4], count = 0;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++)
+            if(rows[step] >= 0 && rows[step] < maze->height &&
+                    columns[step] >= 0 && columns[step] < maze->width &&
+                    TEST_BIT(maze->walls,
+                        ROWS_COORDS(rows[step], columns[step])))
+                choices[count++] = step;
+        if(!count) {
+            depth--;
+            continue;
+        }
+        int step = choices[next_random(seed) % count];
+        CLEAR_BIT(maze->walls, ROWS_COORDS((y + rows[step]) / 2,
+                                    (x + columns[step]) / 2));
+        CLEAR_BIT(maze->walls, ROWS_COORDS(rows[step], columns[step]));
+        if(depth == capacity) {
+            capacity *= 2;
+            stack = realloc(stack, sizeof(uint32_t) * capacity);
+            assert(stack != NULL);
+        }
+        stack[depth++] = (rows[step] / 2) * across + columns[step] / 2;
+    }
+    free(stack);
+
+    // an even size leaves the exit off the rooms, a short dead end
+    // joins it to the nearest one
+    int y = maze->height - 1, x = maze->width - 1;
+    CLEAR_BIT(maze->walls, ROWS_COORDS(y, x));
+    if(y % 2 && x % 2) CLEAR_BIT(maze->walls, ROWS_COORDS(y - 1, x));
+}
+
+/**
+ * carve_rooms()
+ *      splits a maze into rooms and opens one door in each wall
+ *      between two of them
+ * args -
+ *      maze - the maze, every cell open
+ *      seed - the generator
+ */
+static void carve_rooms(Maze maze, uint64_t* seed) {
+    // the last row and column are never walls, so the exit is in a room
+    for(int y = ROOM_SIDE - 1; y < maze->height - 1; y += ROOM_SIDE)
+        for(int x = 0; x < maze->width; x++)
+            SET_BIT(maze->walls, ROWS_COORDS(y, x));
+    for(int x = ROOM_SIDE - 1; x < maze->width - 1; x += ROOM_SIDE)
+        for(int y = 0; y < maze->height; y++)
+            SET_BIT(maze->walls, ROWS_COORDS(y, x));
+
+    for(int top = 0; top < maze->height; top += ROOM_SIDE) {
+        int rows = (top + ROOM_SIDE <= maze->height)?ROOM_SIDE - 1:
+                        maze->height - top;
+        for(int left = 0; left < maze->width; left += ROOM_SIDE) {
+            int columns = (left + ROOM_SIDE <= maze->width)?ROOM_SIDE - 1:
+                            maze->width - left;
+            int below = top + ROOM_SIDE - 1, right = left + ROOM_SIDE - 1;
+            if(below < maze->height - 1)
+                CLEAR_BIT(maze->walls, ROWS_COORDS(below,
+                            left + (int)(next_random(seed) % columns)));
+            if(right < maze->width - 1)
+                CLEAR_BIT(maze->walls, ROWS_COORDS(
+                            top + (int)(next_random(seed) % rows), right));
+        }
+    }
+}
+
+/// Implementation from mazegen.h
+/// maze_family()
+///     finds the family with a name
+int maze_family(const char* name, MazeFamily* family) {
+    for(int f = GEN_PERFECT; f <= GEN_COLUMNS; f++)
+        if(!strcmp(name, FAMILY_NAMES[f])) {
+            *family = (MazeFamily)f;
+            return 1;
+        }
+    return 0;
+}
+
+/// Implementation from mazegen.h
+/// generate_maze()
+///     builds a maze of a family
+Maze generate_maze(MazeFamily family, int width, int height, int density,
+                uint64_t seed) {
+    Maze maze = allocate_maze(width, height, NULL);
+    if(!width || !height) return maze;
+    if(!seed) seed = GEN_SEED;
+
+    if(family == GEN_PERFECT) {
+        fill_walls(maze);
+        carve_perfect(maze, &seed);
+    } else if(family == GEN_ROOMS) {
+        carve_rooms(maze, &seed);
+    } else if(family == GEN_CORRIDOR) {
+        // odd rows are walls with a gap at alternating ends
+        for(int y = 1; y < height; y += 2)
+            for(int x = 0; x < width; x++)
+                if(x != (((y / 2) % 2)?0:width - 1))
+                    SET_BIT(maze->walls, ROWS_COORDS(y, x));
+    } else if(family == GEN_COLUMNS) {
+        // odd columns are walls with a gap at alternating ends
+        for(int x = 1; x < width; x += 2)
+            for(int y = 0; y < height; y++)
+                if(y != (((x / 2) % 2)?0:height - 1))
+                    SET_BIT(maze->walls, ROWS_COORDS(y, x));
+    } else {
+        for(int y = 0; y < height; y++)
+            for(int x = 0; x < width; x++)
+                if(next_random(&seed) % 100 < (uint64_t)density)
+                    SET_BIT(maze->walls, ROWS_COORDS(y, x));
+    }
+    CLEAR_BIT(maze->walls, ROWS_COORDS(0, 0));
+    CLEAR_BIT(maze->walls, ROWS_COORDS(height - 1, width - 1));
+    if(family == GEN_SEALED) {
+        // the cells one move from the exit are walls
+        if(height > 1) SET_BIT(maze->walls, ROWS_COORDS(height - 2, width - 1));
+        if(width > 1) SET_BIT(maze->walls, ROWS_COORDS(height - 1, width - 2));
+    } else if(family == GEN_TERRAIN) {
+        size_t cells = (size_t)width * height;
+        assert(cells <= MAX_WEIGHTED_CELLS);
+        maze->weights = malloc(cells + 1);
+        assert(maze->weights != NULL);
+        for(size_t cell = 0; cell < cells; cell++)
+            maze->weights[cell] = 1 + next_random(&seed) % MAX_WEIGHT;
+        maze->heaviest = MAX_WEIGHT;
+    }
+    return maze;
+}
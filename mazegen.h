@@ -0,0 +1,62 @@
+/// File: mazegen.h
+/// Description: seeded maze generators, the same family, size and seed
+///     always give the same maze so inputs can be rebuilt instead of
+///     stored. Every maze has its start and exit open
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "maze.h"
+
+#ifndef MAZEGEN
+#define MAZEGEN
+
+#define ROOM_SIDE 16 /// cells along a side of a room, walls included
+#define GEN_SEED 2463534242ull /// seed used when none is chosen
+
+/// the kinds of maze generate_maze() builds
+typedef enum {
+    GEN_PERFECT,  /// a recursive backtracker maze, one path between any
+                  /// two open cells and passages one cell wide
+    GEN_ROOMS,    /// open rooms in a grid with one door between each pair
+                  /// of neighboring rooms
+    GEN_RANDOM,   /// every cell a wall with a chosen chance
+    GEN_SEALED,   /// GEN_RANDOM with the exit walled in, so no solution
+    GEN_CORRIDOR, /// one long corridor winding across every other row
+    GEN_TERRAIN,  /// GEN_RANDOM with every open cell costing 1 to
+                  /// MAX_WEIGHT to move into, a weighted maze
+    GEN_COLUMNS   /// one long corridor winding down and up every other
+                  /// column, the worst case for band_solve()
+} MazeFamily;
+
+/**
+ * maze_family()
+ *      finds the family with a name, the names are the families
+ *      in lowercase without GEN_
+ * args -
+ *      name - the name of the family
+ *      family - location to store the family
+ * returns -
+ *      1 if the name is known, 0 otherwise
+ */
+int maze_family(const char* name, MazeFamily* family);
+
+/**
+ * generate_maze()
+ *      builds a maze of a family
+ * args -
+ *      family - the kind of maze
+ *      width - cells per row
+ *      height - the amount of rows
+ *      density - percent of cells walled in GEN_RANDOM, GEN_SEALED
+ *              and GEN_TERRAIN
+ *      seed - the seed of the random choices, 0 for GEN_SEED
+ * returns -
+ *      a pointer to a maze structure, a GEN_TERRAIN maze may have
+ *      at most MAX_WEIGHTED_CELLS cells
+ */
+Maze generate_maze(MazeFamily family, int width, int height, int density,
+                uint64_t seed);
+
+#endif // MAZEGEN
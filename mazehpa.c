@@ -0,0 +1,733 @@
+/// File: mazehpa.c
+/// Description: hierarchical path finding over square clusters of a maze.
+///     Open runs along the border of two clusters are crossed at their
+///     middle when short and at both ends when long, each crossing
+///     giving a node on either side joined by one move. Nodes of one
+///     cluster are joined by their distance inside the cluster. Queries
+///     run A* over this graph and then walk each hop cell by cell inside
+///     the one cluster it stays in.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "arenaADT.h"
+#include "pqueueADT.h"
+#include "mazeimpl.h"
+#include "mazehpa.h"
+
+#define INDEX_MAGIC "MZHPA001" /// the first bytes of an index file
+#define MAGIC_LENGTH 8 /// the length of INDEX_MAGIC
+#define ENTRANCE_SPLIT 6 /// open border runs this long are crossed at both ends
+#define NO_COST UINT32_MAX /// the distance to a node that can not be reached
+
+/// a cell on a cluster border that the path may cross at
+typedef struct {
+    int32_t row;
+    int32_t column;
+    uint32_t cluster; /// the cluster the cell is in
+} Node;
+
+/// a hop from one node to another
+typedef struct {
+    uint32_t target; /// the node reached
+    uint32_t cost; /// the moves taken
+} Edge;
+
+/// a hop while the graph is being built
+typedef struct {
+    uint32_t from;
+    Edge edge;
+} Link;
+
+/// the cells of one cluster
+typedef struct {
+    int top;
+    int left;
+    int rows;
+    int columns;
+} Box;
+
+/// a search confined to one cluster
+typedef struct {
+    uint32_t cluster; /// the cluster loaded, NO_COST before the first
+    Box box; /// the cells of the cluster
+    uint8_t* open; /// 1 for every open cell of the cluster, row by row
+    int32_t* distance; /// the distance to every cell, -1 if not reached
+    uint32_t* queue; /// room for every cell of the cluster
+} Local;
+
+struct HPA_ST {
+    uint64_t hash; /// hash of the grid the index was built from
+    int width; /// cells per row of the maze
+    int height; /// rows of the maze
+    int side; /// cells along a side of a cluster
+    size_t across; /// clusters in a row of clusters
+    size_t clusters; /// the amount of clusters
+    uint32_t nodeCount; /// the amount of nodes
+    Node* nodes; /// every node, ordered by cluster
+    uint32_t* members; /// the nodes of cluster c are members[c] to members[c + 1]
+    uint32_t* first; /// the edges of node n are first[n] to first[n + 1]
+    Edge* edges; /// every edge, grouped by the node they leave
+};
+
+/**
+ * grid_hash()
+ *      hashes the cells of a maze the same way in either layout
+ * args -
+ *      maze - the maze
+ * returns -
+ *      the hash
+ */
+static uint64_t grid_hash(const Maze maze) {
+    uint64_t* walls = (maze->tiled)?layout_walls(maze, 0, NULL):maze->walls;
+    uint64_t hash = hash_words(walls, maze->stride * maze->height,
+                    ((uint64_t)maze->width << 32) | (uint32_t)maze->height);
+    if(walls != maze->walls) free(walls);
+    return hash;
+}
+
+/**
+ * cell_open()
+ *      checks whether a cell is inside the maze and not a wall
+ * args -
+ *      maze - the maze
+ *      row, column - the cell
+ * returns -
+ *      1 if the cell can be walked on, 0 otherwise
+ */
+static int cell_open(const Maze maze, int row, int column) {
+    return row >= 0 && row < maze->height && column >= 0 &&
+            column < maze->width && !TEST_BIT(maze->walls, COORDS(row, column));
+}
+
+/**
+ * cluster_box()
+ *      finds the cells of a cluster
+ * args -
+ *      index - the index
+ *      cluster - the cluster
+ * returns -
+ *      the cells of the cluster, clusters on the far edges may be smaller
+ */
+static Box cluster_box(const PathIndex index, uint32_t cluster) {
+    Box box;
+    box.top = (int)(cluster / index->across) * index->side;
+    box.left = (int)(cluster % index->across) * index->side;
+    box.rows = (box.top + index->side <= index->height)?index->side:
+                    index->height - box.top;
+    box.columns = (box.left + index->side <= index->width)?index->side:
+                    index->width - box.left;
+    return box;
+}
+
+/**
+ * cluster_of()
+ *      finds the cluster a cell is in
+ */
+static uint32_t cluster_of(const PathIndex index, int row, int column) {
+    return (uint32_t)((row / index->side) * index->across +
+                        column / index->side);
+}
+
+/**
+ * local_load()
+ *      readies a local search of a cluster, copying which of its
+ *      cells are open unless the cluster is already loaded
+ * args -
+ *      maze - the maze
+ *      index - the index
+ *      local - the search
+ *      cluster - the cluster to search
+ */
+static void local_load(const Maze maze, const PathIndex index, Local* local,
+                uint32_t cluster) {
+    if(local->cluster == cluster) return;
+    local->cluster = cluster;
+    local->box = cluster_box(index, cluster);
+    const Box* box = &local->box;
+    for(int y = 0; y < box->rows; y++)
+        for(int x = 0; x < box->columns; x++)
+            local->open[y * box->columns + x] = 
+                !TEST_BIT(maze->walls, COORDS(box->top + y, box->left + x));
+}
+
+/**
+ * local_search()
+ *      breadth first search from a cell that never leaves the loaded
+ *      cluster, filling in the distance to the cells it reaches
+ * args -
+ *      local - the search
+ *      row, column - the cell to start from
+ *      stop - the cell of the cluster to stop at once reached, 
+ *              NO_COST to reach every cell
+ *      stats - counters to update, may be NULL
+ */
+static void local_search(Local* local, int row, int column, uint32_t stop,
+                SolveStats* stats) {
+    const Box* box = &local->box;
+    size_t cells = (size_t)box->rows * box->columns, head = 0, tail = 0;
+    int32_t* distance = local->distance;
+    for(size_t cell = 0; cell < cells; cell++) distance[cell] = -1;
+    uint32_t start = (row - box->top) * box->columns + (column - box->left);
+    distance[start] = 0;
+    local->queue[tail++] = start;
+    while(head < tail && (stop == NO_COST || distance[stop] < 0)) {
+        uint32_t cell = local->queue[head++];
+        int y = cell / box->columns, x = cell % box->columns;
+        uint32_t neighbors[] = {
+            (y > 0)?cell - box->columns:NO_COST,
+            (y + 1 < box->rows)?cell + box->columns:NO_COST,
+            (x > 0)?cell - 1:NO_COST,
+            (x + 1 < box->columns)?cell + 1:NO_COST};
+        if(stats != NULL) stats->expanded++;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            uint32_t next = neighbors[step];
+            if(next == NO_COST || distance[next] >= 0 || !local->open[next])
+                continue;
+            distance[next] = distance[cell] + 1;
+            local->queue[tail++] = next;
+            if(stats != NULL) stats->pushed++;
+        }
+    }
+}
+
+/**
+ * local_distance()
+ *      the distance found by the last local search to a cell
+ * args -
+ *      local - the search
+ *      node - the cell, inside the loaded cluster
+ * returns -
+ *      the distance, or NO_COST if the cell was not reached
+ */
+static uint32_t local_distance(const Local* local, const Node* node) {
+    int32_t d = local->distance[(node->row - local->box.top) * 
+                    local->box.columns + node->column - local->box.left];
+    return (d < 0)?NO_COST:(uint32_t)d;
+}
+
+/**
+ * add_node()
+ *      adds a crossing cell to the nodes being built
+ * args -
+ *      index - the index being built
+ *      nodes - the nodes so far, grown as needed
+ *      capacity - the room in nodes
+ *      row, column - the cell
+ */
+static void add_node(PathIndex index, Node** nodes, size_t* capacity,
+                int row, int column) {
+    if(index->nodeCount == *capacity) {
+        *capacity = (*capacity)?*capacity * 2:64;
+        *nodes = realloc(*nodes, sizeof(Node) * *capacity);
+        assert(*nodes != NULL);
+    }
+    Node node = {row, column, cluster_of(index, row, column)};
+    (*nodes)[index->nodeCount++] = node;
+}
+
+/**
+ * add_crossings()
+ *      adds the nodes where a border between two clusters is crossed
+ * args -
+ *      maze - the maze
+ *      index - the index being built
+ *      nodes - the nodes so far, grown as needed
+ *      capacity - the room in nodes
+ *      row, column - the first cell of the border on the near side
+ *      vertical - 1 if the border runs down between column and
+ *              column + 1, 0 if it runs across between row and row + 1
+ *      length - the amount of cells along the border
+ */
+static void add_crossings(const Maze maze, PathIndex index, Node** nodes,
+                size_t* capacity, int row, int column, int vertical,
+                int length) {
+    int run = -1; // the start of the open run, -1 outside one
+    for(int at = 0; at <= length; at++) {
+        int y = row + ((vertical)?at:0), x = column + ((vertical)?0:at);
+        int open = at < length && cell_open(maze, y, x) &&
+                cell_open(maze, y + !vertical, x + vertical);
+        if(open && run < 0) run = at;
+        if(open || run < 0) continue;
+        // both sides of each crossing become nodes
+        int ends[] = {run, at - 1};
+        int count = (at - run < ENTRANCE_SPLIT)?1:2;
+        if(count == 1) ends[0] = (run + at - 1) / 2;
+        for(int e = 0; e < count; e++) {
+            int ey = row + ((vertical)?ends[e]:0);
+            int ex = column + ((vertical)?0:ends[e]);
+            add_node(index, nodes, capacity, ey, ex);
+            add_node(index, nodes, capacity, ey + !vertical, ex + vertical);
+        }
+        run = -1;
+    }
+}
+
+/**
+ * compare_nodes()
+ *      orders nodes by cluster, then row, then column
+ */
+static int compare_nodes(const void* lhs, const void* rhs) {
+    const Node* a = lhs;
+    const Node* b = rhs;
+    if(a->cluster != b->cluster) return (a->cluster < b->cluster)?-1:1;
+    if(a->row != b->row) return (a->row < b->row)?-1:1;
+    return (a->column > b->column) - (a->column < b->column);
+}
+
+/**
+ * find_node()
+ *      finds the node at a cell
+ * args -
+ *      index - the index
+ *      row, column - the cell
+ * returns -
+ *      the node, or NO_COST if the cell is not a node
+ */
+static uint32_t find_node(const PathIndex index, int row, int column) {
+    Node key = {row, column, cluster_of(index, row, column)};
+    const Node* base = index->nodes + index->members[key.cluster];
+    const Node* found = bsearch(&key, base,
+            index->members[key.cluster + 1] - index->members[key.cluster],
+            sizeof(Node), compare_nodes);
+    return (found == NULL)?NO_COST:(uint32_t)(found - index->nodes);
+}
+
+/**
+ * index_members()
+ *      groups the sorted nodes of an index by cluster
+ * args -
+ *      index - the index, with nodes sorted by cluster
+ */
+static void index_members(PathIndex index) {
+    index->members = calloc(index->clusters + 1, sizeof(uint32_t));
+    assert(index->members != NULL);
+    for(uint32_t n = 0; n < index->nodeCount; n++)
+        index->members[index->nodes[n].cluster + 1]++;
+    for(size_t c = 0; c < index->clusters; c++)
+        index->members[c + 1] += index->members[c];
+}
+
+/**
+ * add_link()
+ *      adds a hop to the hops being built
+ * args -
+ *      links - the hops so far, grown as needed
+ *      count - the amount of hops
+ *      capacity - the room in links
+ *      from - the node the hop leaves
+ *      to - the node the hop reaches
+ *      cost - the moves taken
+ */
+static void add_link(Link** links, size_t* count, size_t* capacity,
+                uint32_t from, uint32_t to, uint32_t cost) {
+    if(*count == *capacity) {
+        *capacity = (*capacity)?*capacity * 2:256;
+        *links = realloc(*links, sizeof(Link) * *capacity);
+        assert(*links != NULL);
+    }
+    Link link = {from, {to, cost}};
+    (*links)[(*count)++] = link;
+}
+
+/**
+ * create_index()
+ *      allocates an empty index for a maze
+ */
+static PathIndex create_index(const Maze maze, int side) {
+    PathIndex index = calloc(1, sizeof(struct HPA_ST));
+    assert(index != NULL);
+    index->width = maze->width;
+    index->height = maze->height;
+    index->side = side;
+    index->across = (maze->width + side - 1) / side;
+    index->clusters = index->across * ((maze->height + side - 1) / side);
+    return index;
+}
+
+/// Implementation from mazehpa.h
+/// hpa_build()
+///     builds the index of a maze
+PathIndex hpa_build(const Maze maze, int side) {
+    if(side < 1) side = CLUSTER_SIDE;
+    PathIndex index = create_index(maze, side);
+    index->hash = grid_hash(maze);
+
+    // crossings are found in pairs, the near side then the far side
+    size_t capacity = 0;
+    for(size_t cluster = 0; cluster < index->clusters; cluster++) {
+        Box box = cluster_box(index, cluster);
+        if(box.left + box.columns < maze->width)
+            add_crossings(maze, index, &index->nodes, &capacity, box.top,
+                    box.left + box.columns - 1, 1, box.rows);
+        if(box.top + box.rows < maze->height)
+            add_crossings(maze, index, &index->nodes, &capacity,
+                    box.top + box.rows - 1, box.left, 0, box.columns);
+    }
+    size_t pairs = index->nodeCount / 2;
+    Node* crossings = index->nodes;
+
+    // a cell may cross two borders at a corner, it is one node
+    index->nodes = malloc(sizeof(Node) * (index->nodeCount + 1));
+    assert(index->nodes != NULL);
+    if(index->nodeCount)
+        memcpy(index->nodes, crossings, sizeof(Node) * index->nodeCount);
+    qsort(index->nodes, index->nodeCount, sizeof(Node), compare_nodes);
+    uint32_t unique = 0;
+    for(uint32_t n = 0; n < index->nodeCount; n++)
+        if(!unique || compare_nodes(&index->nodes[unique - 1], &index->nodes[n]))
+            index->nodes[unique++] = index->nodes[n];
+    index->nodeCount = unique;
+    index_members(index);
+
+    Link* links = NULL;
+    size_t linkCount = 0, linkCapacity = 0;
+    for(size_t p = 0; p < pairs; p++) {
+        uint32_t near = find_node(index, crossings[2 * p].row,
+                                    crossings[2 * p].column);
+        uint32_t far = find_node(index, crossings[2 * p + 1].row,
+                                    crossings[2 * p + 1].column);
+        add_link(&links, &linkCount, &linkCapacity, near, far, 1);
+        add_link(&links, &linkCount, &linkCapacity, far, near, 1);
+    }
+    free(crossings);
+
+    // distances between the nodes of each cluster
+    size_t cells = (size_t)side * side;
+    Local local = {NO_COST, {0, 0, 0, 0}, malloc(cells), 
+                    malloc(sizeof(int32_t) * cells), 
+                    malloc(sizeof(uint32_t) * cells)};
+    assert(local.open != NULL && local.distance != NULL && local.queue != NULL);
+    for(size_t cluster = 0; cluster < index->clusters; cluster++) {
+        for(uint32_t a = index->members[cluster];
+                a < index->members[cluster + 1]; a++) {
+            const Node* from = &index->nodes[a];
+            local_load(maze, index, &local, cluster);
+            local_search(&local, from->row, from->column, NO_COST, NULL);
+            for(uint32_t b = index->members[cluster];
+                    b < index->members[cluster + 1]; b++) {
+                uint32_t cost = local_distance(&local, &index->nodes[b]);
+                if(a != b && cost != NO_COST && cost > 0)
+                    add_link(&links, &linkCount, &linkCapacity, a, b, cost);
+            }
+        }
+    }
+    free(local.open);
+    free(local.distance);
+    free(local.queue);
+
+    // hops are grouped by the node they leave
+    index->first = calloc(index->nodeCount + 1, sizeof(uint32_t));
+    index->edges = malloc(sizeof(Edge) * (linkCount + 1));
+    assert(index->first != NULL && index->edges != NULL);
+    for(size_t l = 0; l < linkCount; l++)
+        index->first[links[l].from + 1]++;
+    for(uint32_t n = 0; n < index->nodeCount; n++)
+        index->first[n + 1] += index->first[n];
+    uint32_t* fill = malloc(sizeof(uint32_t) * (index->nodeCount + 1));
+    assert(fill != NULL);
+    memcpy(fill, index->first, sizeof(uint32_t) * (index->nodeCount + 1));
+    for(size_t l = 0; l < linkCount; l++)
+        index->edges[fill[links[l].from]++] = links[l].edge;
+    free(fill);
+    free(links);
+    return index;
+}
+
+/// Implementation from mazehpa.h
+/// hpa_destroy()
+///     free all memory held by an index
+void hpa_destroy(PathIndex index) {
+    if(index == NULL) return;
+    free(index->nodes);
+    free(index->members);
+    free(index->first);
+    free(index->edges);
+    free(index);
+}
+
+/// Implementation from mazehpa.h
+/// hpa_nodes()
+///     reports the size of the graph searched by queries
+size_t hpa_nodes(PathIndex index) {
+    return index->nodeCount;
+}
+
+/**
+ * walk_hop()
+ *      marks the cells of a hop between two cells of one cluster
+ * args -
+ *      maze - the maze to mark the path in
+ *      index - the index
+ *      local - a search to walk the cluster with
+ *      from - the cell the hop starts at
+ *      to - the cell the hop ends at
+ *      stats - counters to update
+ */
+static void walk_hop(Maze maze, const PathIndex index, Local* local, 
+                const Node* from, const Node* to, SolveStats* stats) {
+    local_load(maze, index, local, from->cluster);
+    const Box box = local->box;
+    const int32_t* distance = local->distance;
+    int y = from->row - box.top, x = from->column - box.left;
+    // searched from the far end so the walk only follows distances down
+    local_search(local, to->row, to->column, y * box.columns + x, stats);
+    SET_BIT(maze->path, COORDS(from->row, from->column));
+    // every cell but the end has a neighbor one move closer to it
+    while(distance[y * box.columns + x] > 0) {
+        int32_t closer = distance[y * box.columns + x] - 1;
+        int ys[] = {y - 1, y + 1, y, y}, xs[] = {x, x, x - 1, x + 1};
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++)
+            if(ys[step] >= 0 && ys[step] < box.rows && xs[step] >= 0 &&
+                    xs[step] < box.columns &&
+                    distance[ys[step] * box.columns + xs[step]] == closer) {
+                y = ys[step];
+                x = xs[step];
+                break;
+            }
+        SET_BIT(maze->path, COORDS(box.top + y, box.left + x));
+    }
+}
+
+/**
+ * hop_priority()
+ *      the A* queue priority of a node, f = g + h with h in the low bits
+ * args -
+ *      node - the node
+ *      goal - the goal
+ *      cost - the moves taken to reach the node (g)
+ * returns -
+ *      the priority of the node, lowest comes out first
+ */
+static uint64_t hop_priority(const Node* node, const Node* goal,
+                uint64_t cost) {
+    uint64_t h = labs((long)node->row - goal->row) + 
+                    labs((long)node->column - goal->column);
+    return ((cost + h) << TIE_BITS) | ((h < TIE_MASK)?h:TIE_MASK);
+}
+
+/// Implementation from mazehpa.h
+/// hpa_solve()
+///     finds a path between two cells and marks it in the maze
+int hpa_solve(PathIndex index, Maze maze, int startRow, int startColumn,
+                int goalRow, int goalColumn, SolveStats* stats) {
+    SolveStats counts = {0, 0};
+    // forget any previous solution
+    prepare_search(maze);
+    if(stats == NULL) stats = &counts;
+    *stats = counts;
+    if(maze->width != index->width || maze->height != index->height ||
+            !cell_open(maze, startRow, startColumn) ||
+            !cell_open(maze, goalRow, goalColumn))
+        return -1;
+
+    // the start and goal join the graph as two more nodes
+    uint32_t start = index->nodeCount, goal = index->nodeCount + 1;
+    uint32_t total = index->nodeCount + 2;
+    uint32_t startCluster = cluster_of(index, startRow, startColumn);
+    uint32_t goalCluster = cluster_of(index, goalRow, goalColumn);
+    Node ends[] = {{startRow, startColumn, startCluster},
+                    {goalRow, goalColumn, goalCluster}};
+    size_t cells = (size_t)index->side * index->side;
+    Local local = {NO_COST, {0, 0, 0, 0}, arena_alloc(maze->search, cells),
+                    arena_alloc(maze->search, sizeof(int32_t) * cells),
+                    arena_alloc(maze->search, sizeof(uint32_t) * cells)};
+    uint32_t* cost = arena_alloc(maze->search, sizeof(uint32_t) * total);
+    uint32_t* parent = arena_alloc(maze->search, sizeof(uint32_t) * total);
+    uint32_t* startCost = arena_alloc(maze->search, sizeof(uint32_t) *
+            (index->members[startCluster + 1] - index->members[startCluster] + 1));
+    uint32_t* goalCost = arena_alloc(maze->search, sizeof(uint32_t) *
+            (index->members[goalCluster + 1] - index->members[goalCluster] + 1));
+    uint32_t direct = NO_COST;
+
+    // how far the start and goal are from the nodes of their clusters
+    for(int end = 0; end < 2; end++) {
+        uint32_t cluster = (end)?goalCluster:startCluster;
+        uint32_t* found = (end)?goalCost:startCost;
+        local_load(maze, index, &local, cluster);
+        local_search(&local, ends[end].row, ends[end].column, NO_COST, stats);
+        for(uint32_t n = index->members[cluster];
+                n < index->members[cluster + 1]; n++)
+            found[n - index->members[cluster]] = 
+                local_distance(&local, &index->nodes[n]);
+        if(!end && goalCluster == startCluster)
+            direct = local_distance(&local, &ends[1]);
+    }
+
+    for(uint32_t n = 0; n < total; n++) cost[n] = NO_COST;
+    PQueue next = pq_create_in(maze->search, SEARCH_RESERVE / 16);
+    cost[start] = 0;
+    parent[start] = start;
+    pq_push(next, hop_priority(&ends[0], &ends[1], 0), start);
+    stats->pushed++;
+    while(!pq_empty(next)) {
+        uint64_t rank;
+        uint32_t node = (uint32_t)pq_pop(next, &rank);
+        const Node* at = (node == start)?&ends[0]:
+                            (node == goal)?&ends[1]:&index->nodes[node];
+        // a node queued again at a lower cost leaves its old entry behind
+        if(rank != hop_priority(at, &ends[1], cost[node])) continue;
+        if(node == goal) break;
+        stats->expanded++;
+
+        // the hops out of the node, the start's were found above
+        size_t count = (node == start)?
+            index->members[startCluster + 1] - index->members[startCluster]:
+            index->first[node + 1] - index->first[node];
+        for(size_t e = 0; e <= count; e++) {
+            uint32_t target, step;
+            if(e == count) { // the hop to the goal, if the goal is close
+                target = goal;
+                if(node == start) step = direct;
+                else if(index->nodes[node].cluster == goalCluster)
+                    step = goalCost[node - index->members[goalCluster]];
+                else continue;
+            } else if(node == start) {
+                target = index->members[startCluster] + e;
+                step = startCost[e];
+            } else {
+                target = index->edges[index->first[node] + e].target;
+                step = index->edges[index->first[node] + e].cost;
+            }
+            if(step == NO_COST || 
+                    (uint64_t)cost[node] + step >= cost[target]) 
+                continue;
+            cost[target] = cost[node] + step;
+            parent[target] = node;
+            const Node* to = (target == goal)?&ends[1]:&index->nodes[target];
+            pq_push(next, hop_priority(to, &ends[1], cost[target]), target);
+            stats->pushed++;
+        }
+    }
+    if(cost[goal] == NO_COST) return -1;
+
+    // every hop stays in one cluster, except the single moves
+    // across a border which join two neighboring cells
+    for(uint32_t node = goal; node != start; node = parent[node]) {
+        uint32_t from = parent[node];
+        const Node* a = (from == start)?&ends[0]:&index->nodes[from];
+        const Node* b = (node == goal)?&ends[1]:&index->nodes[node];
+        if(a->cluster == b->cluster) {
+            walk_hop(maze, index, &local, a, b, stats);
+        } else {
+            SET_BIT(maze->path, COORDS(a->row, a->column));
+            SET_BIT(maze->path, COORDS(b->row, b->column));
+        }
+    }
+    SET_BIT(maze->path, COORDS(goalRow, goalColumn));
+    return cost[goal] + 1;
+}
+
+/// Implementation from mazehpa.h
+/// hpa_load()
+///     reads an index saved by hpa_save()
+PathIndex hpa_load(const Maze maze, const char* path) {
+    FILE* input = fopen(path, "rb");
+    if(input == NULL) return NULL;
+    char magic[MAGIC_LENGTH];
+    uint64_t hash;
+    int32_t fields[3];
+    uint32_t counts[2];
+    if(fread(magic, 1, MAGIC_LENGTH, input) != MAGIC_LENGTH ||
+            memcmp(magic, INDEX_MAGIC, MAGIC_LENGTH) ||
+            fread(&hash, sizeof(hash), 1, input) != 1 ||
+            fread(fields, sizeof(fields), 1, input) != 1 ||
+            fread(counts, sizeof(counts), 1, input) != 1) {
+        fprintf(stderr, "%s: not a maze index\n", path);
+        fclose(input);
+        return NULL;
+    }
+    if(fields[0] != maze->width || fields[1] != maze->height ||
+            fields[2] < 1 || hash != grid_hash(maze)) {
+        fprintf(stderr, "%s: index was built from another maze\n", path);
+        fclose(input);
+        return NULL;
+    }
+    // a node is a cell, and has a hop to at most every other node
+    // of its cluster and across two borders
+    if(counts[0] > (size_t)maze->width * maze->height || 
+            counts[1] > counts[0] * (4 * (size_t)fields[2] + 2)) {
+        fprintf(stderr, "%s: index file is damaged\n", path);
+        fclose(input);
+        return NULL;
+    }
+
+    PathIndex index = create_index(maze, fields[2]);
+    index->hash = hash;
+    index->nodeCount = counts[0];
+    index->nodes = malloc(sizeof(Node) * ((size_t)counts[0] + 1));
+    index->first = malloc(sizeof(uint32_t) * ((size_t)counts[0] + 1));
+    index->edges = malloc(sizeof(Edge) * ((size_t)counts[1] + 1));
+    if(index->nodes == NULL || index->first == NULL || index->edges == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    int valid = fread(index->nodes, sizeof(Node), counts[0], input) == counts[0] &&
+        fread(index->first, sizeof(uint32_t), counts[0] + (size_t)1, input) ==
+            counts[0] + (size_t)1 &&
+        fread(index->edges, sizeof(Edge), counts[1], input) == counts[1] &&
+        index->first[0] == 0 && index->first[counts[0]] == counts[1];
+    // the graph is checked so queries never leave it or the maze
+    for(uint32_t n = 0; valid && n < counts[0]; n++) {
+        const Node* node = &index->nodes[n];
+        valid = cell_open(maze, node->row, node->column) &&
+            node->cluster == cluster_of(index, node->row, node->column) &&
+            (!n || compare_nodes(&index->nodes[n - 1], node) < 0) &&
+            index->first[n] <= index->first[n + 1];
+    }
+    for(uint32_t e = 0; valid && e < counts[1]; e++)
+        valid = index->edges[e].target < counts[0];
+    fclose(input);
+    if(!valid) {
+        fprintf(stderr, "%s: index file is damaged\n", path);
+        hpa_destroy(index);
+        return NULL;
+    }
+    index_members(index);
+    return index;
+}
+
+/// Implementation from mazehpa.h
+/// hpa_save()
+///     writes an index to a file
+int hpa_save(PathIndex index, const char* path) {
+    // written beside the old file and moved over it, so a failed
+    // save never leaves a damaged index behind
+    size_t length = strlen(path) + 5;
+    char* temporary = malloc(length);
+    if(temporary == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(temporary, length, "%s.tmp", path);
+    FILE* output = fopen(temporary, "wb");
+    if(output == NULL) {
+        perror(temporary);
+        free(temporary);
+        return -1;
+    }
+
+    int32_t fields[] = {index->width, index->height, index->side};
+    uint32_t counts[] = {index->nodeCount, index->first[index->nodeCount]};
+    fwrite(INDEX_MAGIC, 1, MAGIC_LENGTH, output);
+    fwrite(&index->hash, sizeof(index->hash), 1, output);
+    fwrite(fields, sizeof(fields), 1, output);
+    fwrite(counts, sizeof(counts), 1, output);
+    fwrite(index->nodes, sizeof(Node), index->nodeCount, output);
+    fwrite(index->first, sizeof(uint32_t), index->nodeCount + (size_t)1, output);
+    fwrite(index->edges, sizeof(Edge), counts[1], output);
+
+    int status = (ferror(output) | fclose(output) || rename(temporary, path))?-1:0;
+    if(status) {
+        perror(path);
+        remove(temporary);
+    }
+    free(temporary);
+    return status;
+}
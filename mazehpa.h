@@ -0,0 +1,94 @@
+/// File: mazehpa.h
+/// Description: a hierarchical index of a maze for answering many
+///     path queries on it. The grid is split into square clusters,
+///     cells where open borders between clusters can be crossed become
+///     the nodes of a small graph, and the distances between nodes of
+///     the same cluster are found once. A query searches that graph and
+///     only walks the cells of the clusters its path passes through.
+///
+///     paths found this way are close to, but not always, the shortest
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <sys/types.h>
+#include "maze.h"
+
+#ifndef MAZEHPA
+#define MAZEHPA
+
+#define CLUSTER_SIDE 32 /// default cells along a side of a cluster
+
+/// represent a hierarchical index of one maze
+typedef struct HPA_ST* PathIndex;
+
+/**
+ * hpa_build()
+ *      builds the index of a maze
+ * args -
+ *      maze - the maze to index
+ *      side - cells along a side of a cluster, below 1 for CLUSTER_SIDE
+ * returns -
+ *      the index
+ */
+PathIndex hpa_build(const Maze maze, int side);
+
+/**
+ * hpa_destroy()
+ *      free all memory held by an index
+ * args -
+ *      index - the index to free
+ */
+void hpa_destroy(PathIndex index);
+
+/**
+ * hpa_nodes()
+ *      reports the size of the graph searched by queries
+ * args -
+ *      index - the index
+ * returns -
+ *      the amount of border cells in the graph
+ */
+size_t hpa_nodes(PathIndex index);
+
+/**
+ * hpa_solve()
+ *      finds a path between two cells of the maze the index was built
+ *      from and marks it in the maze's solution bitmap, any previous
+ *      solution is discarded
+ * args -
+ *      index - the index of the maze
+ *      maze - the maze to mark the path in
+ *      startRow, startColumn - the cell the path starts at
+ *      goalRow, goalColumn - the cell the path ends at
+ *      stats - location to store search counters, may be NULL
+ * returns -
+ *      the path distance (min: 1), or -1 if there is no path or
+ *      either cell is a wall or outside the maze
+ */
+int hpa_solve(PathIndex index, Maze maze, int startRow, int startColumn,
+                int goalRow, int goalColumn, SolveStats* stats);
+
+/**
+ * hpa_load()
+ *      reads an index saved by hpa_save()
+ * args -
+ *      maze - the maze the index must have been built from
+ *      path - the index file
+ * returns -
+ *      the index, or NULL if the file is missing, damaged or was
+ *      built from a different maze
+ */
+PathIndex hpa_load(const Maze maze, const char* path);
+
+/**
+ * hpa_save()
+ *      writes an index to a file in the byte order of this machine
+ * args -
+ *      index - the index
+ *      path - the index file
+ * returns -
+ *      0 on success, -1 if the file could not be written
+ */
+int hpa_save(PathIndex index, const char* path);
+
+#endif // MAZEHPA
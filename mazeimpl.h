@@ -0,0 +1,423 @@
+/// File: mazeimpl.h
+/// Description: the maze structure and helpers shared by
+///     the maze loader and the solvers, not part of the maze.h interface
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+
+#ifndef MAZEIMPL
+#define MAZEIMPL
+
+#define WORD_BITS 64 /// cells packed into one bitmap word
+
+/// cells are packed one bit per cell, every row starts on a word boundary
+/// so a cell is addressed by y * pitch + x where pitch = stride * WORD_BITS.
+///
+/// tiled mazes instead keep TILE_SIDE by TILE_SIDE cell tiles in 
+/// consecutive words, one word per row of the tile, with the tiles in
+/// row major order and stride tiles across. Moving up or down inside a
+/// tile stays within 512 bytes however wide the maze is. The cells of
+/// a tile past the width or height of the maze are walls
+struct MAZE_ST {
+    uint64_t* walls; /// set bit for every wall in the maze
+    void* mapping; /// the binary file walls points into, NULL when allocated
+    size_t mapped; /// the size of mapping
+    size_t wallRoom; /// words walls has room for besides the trailing zero,
+                     /// 0 when mapped or sized by its reader
+    size_t pathRoom; /// words path has room for besides the trailing zero
+    uint64_t* path; /// set bit for every cell on the solution
+    Arena search; /// holds the state of the last solve, reset by the next one
+    uint64_t* visited; /// set bit for every cell the solver has expanded
+    uint64_t* steps; /// two bits per cell, the step the solver took into it
+    size_t stride; /// words per row in each bitmap, tiles per row when tiled
+    size_t pitch; /// cells per row including padding (stride * WORD_BITS)
+    size_t words; /// words in each bitmap, not counting the trailing zero
+    size_t span; /// cells in a row of tiles when tiled
+    uint32_t* labels; /// the region of every cell row by row, 0 for walls,
+                      /// NULL until label_maze() and whenever cells change
+    size_t regions; /// the amount of regions in labels
+    uint8_t* weights; /// the cost of moving into every cell row by row,
+                      /// NULL when every open cell costs 1
+    int heaviest; /// the largest cost in weights, 1 without weights
+    int tiled; /// set when the bitmaps are laid out in tiles
+    int width;
+    int height;
+};
+
+#include "maze.h"
+
+#define NO_CELL ((size_t)-1) /// returned by the neighbor macros when out of bounds
+
+#define TILE_SHIFT 6 /// log2 of the cells along a side of a tile
+#define TILE_SIDE (1 << TILE_SHIFT) /// cells along a side of a tile, a word
+#define TILE_CELLS ((size_t)TILE_SIDE * TILE_SIDE) /// cells in a tile
+#define TILE_EDGE (TILE_SIDE - 1) /// the last row or column of a tile
+#define TILE_OF(index) ((index) >> (2 * TILE_SHIFT))
+#define TILE_Y(index) (((index) >> TILE_SHIFT) & TILE_EDGE)
+#define TILE_X(index) ((index) & TILE_EDGE)
+
+/// row major addressing
+#define ROWS_COORDS(y, x) ((size_t)(y) * maze->pitch + (x))
+#define ROWS_COLUMN(index) ((index) % maze->pitch)
+#define ROWS_ROW(index) ((index) / maze->pitch)
+#define ROWS_ABOVE(index) (((index) >= maze->pitch)?(index) - maze->pitch:NO_CELL)
+#define ROWS_BELOW(index) ((ROWS_ROW(index) + 1 < (size_t)maze->height) \
+                            ?(index) + maze->pitch:NO_CELL)
+#define ROWS_LEFT(index) ((ROWS_COLUMN(index))?(index) - 1:NO_CELL)
+#define ROWS_RIGHT(index) ((ROWS_COLUMN(index) + 1 < (size_t)maze->width) \
+                            ?(index) + 1:NO_CELL)
+
+/// tiled addressing, only crossing into another tile divides.
+/// The edge of a tile past the maze is walled, so the far bounds 
+/// are only checked against the tile grid
+#define TILES_COORDS(y, x) \
+    (((((size_t)(y) >> TILE_SHIFT) * maze->stride + ((size_t)(x) >> TILE_SHIFT)) \
+        << (2 * TILE_SHIFT)) | (((size_t)(y) & TILE_EDGE) << TILE_SHIFT) | \
+        ((size_t)(x) & TILE_EDGE))
+#define TILES_COLUMN(index) \
+    (((TILE_OF(index) % maze->stride) << TILE_SHIFT) | TILE_X(index))
+#define TILES_ROW(index) \
+    (((TILE_OF(index) / maze->stride) << TILE_SHIFT) | TILE_Y(index))
+#define TILES_ABOVE(index) ((TILE_Y(index))?(index) - TILE_SIDE: \
+    ((index) >= maze->span)?(index) - maze->span + TILE_EDGE * TILE_SIDE:NO_CELL)
+#define TILES_BELOW(index) ((TILE_Y(index) != TILE_EDGE)?(index) + TILE_SIDE: \
+    ((index) + maze->span < maze->words * WORD_BITS) \
+        ?(index) + maze->span - TILE_EDGE * TILE_SIDE:NO_CELL)
+#define TILES_LEFT(index) ((TILE_X(index))?(index) - 1: \
+    (TILE_OF(index) % maze->stride)?(index) - TILE_CELLS + TILE_EDGE:NO_CELL)
+#define TILES_RIGHT(index) ((TILE_X(index) != TILE_EDGE)?(index) + 1: \
+    (TILE_OF(index) % maze->stride + 1 < maze->stride) \
+        ?(index) + TILE_CELLS - TILE_EDGE:NO_CELL)
+
+/// neighbor lookups for either layout, a solver written with these runs
+/// unchanged on both. The layout of a maze never changes during a solve
+/// so the choice is always predicted
+#define COORDS(y, x) ((maze->tiled)?TILES_COORDS(y, x):ROWS_COORDS(y, x))
+#define COLUMN(index) ((maze->tiled)?TILES_COLUMN(index):ROWS_COLUMN(index))
+#define ROW(index) ((maze->tiled)?TILES_ROW(index):ROWS_ROW(index))
+#define ABOVE(index) ((maze->tiled)?TILES_ABOVE(index):ROWS_ABOVE(index))
+#define BELOW(index) ((maze->tiled)?TILES_BELOW(index):ROWS_BELOW(index))
+#define LEFT(index) ((maze->tiled)?TILES_LEFT(index):ROWS_LEFT(index))
+#define RIGHT(index) ((maze->tiled)?TILES_RIGHT(index):ROWS_RIGHT(index))
+
+#define TEST_BIT(map, index) \
+    (((map)[(index) / WORD_BITS] >> ((index) % WORD_BITS)) & 1)
+#define SET_BIT(map, index) \
+    ((map)[(index) / WORD_BITS] |= (uint64_t)1 << ((index) % WORD_BITS))
+
+
+
+#define STEP_UP 0 /// moved to the cell above
+#define STEP_DOWN 1 /// moved to the cell below
+#define STEP_LEFT 2 /// moved to the cell on the left
+#define STEP_RIGHT 3 /// moved to the cell on the right
+#define STEP_BITS 2 /// bits used to store a step
+
+
+#define GET_STEP(map, index) ((int)(((map)[(index) / (WORD_BITS / STEP_BITS)] \
+    >> ((index) % (WORD_BITS / STEP_BITS) * STEP_BITS)) & 3))
+#define SET_STEP(map, index, step) ((map)[(index) / (WORD_BITS / STEP_BITS)] = \
+    ((map)[(index) / (WORD_BITS / STEP_BITS)] & \
+        ~((uint64_t)3 << ((index) % (WORD_BITS / STEP_BITS) * STEP_BITS))) | \
+    ((uint64_t)(step) << ((index) % (WORD_BITS / STEP_BITS) * STEP_BITS)))
+/// the cell a step was taken from
+#define ROWS_PREVIOUS(index, step) ((step) == STEP_UP?(index) + maze->pitch: \
+    (step) == STEP_DOWN?(index) - maze->pitch: \
+    (step) == STEP_LEFT?(index) + 1:(index) - 1)
+#define TILES_PREVIOUS(index, step) ((step) == STEP_UP?TILES_BELOW(index): \
+    (step) == STEP_DOWN?TILES_ABOVE(index): \
+    (step) == STEP_LEFT?TILES_RIGHT(index):TILES_LEFT(index))
+#define PREVIOUS(index, step) ((maze->tiled)?TILES_PREVIOUS(index, step): \
+    ROWS_PREVIOUS(index, step))
+
+/// queued items carry the cell and the step that led to it
+#define ITEM(index, step) (((uint64_t)(index) << STEP_BITS) | (step))
+#define ITEM_CELL(item) ((size_t)((item) >> STEP_BITS))
+#define ITEM_STEP(item) ((int)((item) & 3))
+
+#define SEARCH_RESERVE (1 << 16) /// arena bytes set aside for the queue
+
+#define TIE_BITS 24 /// low bits of an A* priority used to break ties
+#define TIE_MASK (((uint64_t)1 << TIE_BITS) - 1)
+
+/// a cell is open when it is in bounds, not a wall and not yet visited,
+/// the wall and visited words are merged so the test is a single bit check
+#define OPEN_IN(visited, index) ((index) != NO_CELL && \
+    !((((maze->walls[(index) / WORD_BITS] | (visited)[(index) / WORD_BITS]) \
+        >> ((index) % WORD_BITS)) & 1)))
+#define OPEN(index) OPEN_IN(maze->visited, index)
+
+/**
+ * allocate_maze()
+ *      create a maze structure sized to hold width by height cells,
+ *      the wall bitmap may be provided by the caller
+ * args -
+ *      width - cells per row
+ *      height - the amount of rows
+ *      walls - wall bitmap to adopt, NULL to allocate an empty one
+ * returns -
+ *      a pointer to a maze structure
+ */
+Maze allocate_maze(int width, int height, uint64_t* walls);
+
+/**
+ * workspace_view()
+ *      makes a copy of a maze whose search state and path are a
+ *      workspace's, a solver run on the copy leaves the maze unchanged
+ * args -
+ *      maze - the maze to solve
+ *      work - the workspace, its path is grown to fit the maze
+ *      view - location to store the copy
+ */
+void workspace_view(const Maze maze, Workspace work, struct MAZE_ST* view);
+
+/**
+ * workspace_keep()
+ *      keeps the search state made by a solve of a workspace_view()
+ * args -
+ *      work - the workspace the view was made with
+ *      view - the solved view
+ */
+void workspace_keep(Workspace work, const struct MAZE_ST* view);
+
+/**
+ * trim_length()
+ *      finds the length of text once trailing whitespace is removed,
+ *      so blank lines at the end of a file are not read as rows
+ * args -
+ *      text - the text of the maze
+ *      length - bytes available in text
+ * returns -
+ *      the length without trailing whitespace
+ */
+size_t trim_length(const char* text, size_t length);
+
+/**
+ * report_row_error()
+ *      describe an invalid character found by parse_row()
+ * args -
+ *      text - the start of the row
+ *      length - the amount of characters available from text
+ *      offset - the offset of the invalid character
+ *      row - the row being read, counting from 0
+ *      width - the amount of cells each row should have
+ */
+void report_row_error(const char* text, size_t length, 
+                size_t offset, int row, int width);
+
+/**
+ * print_band()
+ *      prints the rows of a band of a larger maze exactly as
+ *      pretty_print_maze() prints them in the whole maze, so a maze
+ *      printed band by band in order is the same as printed at once
+ * args -
+ *      band - the rows to print, row major
+ *      first - the row of the whole maze that the band starts at
+ *      height - the amount of rows in the whole maze
+ *      output - output stream to print the rows to
+ */
+void print_band(const Maze band, size_t first, size_t height, FILE* output);
+
+/**
+ * is_binary()
+ *      checks whether the start of a file is a binary maze header
+ * args -
+ *      head - the first bytes of the file
+ *      length - the amount of bytes in head
+ * returns -
+ *      1 if the file is in the binary format, 0 otherwise
+ */
+int is_binary(const char* head, size_t length);
+
+/**
+ * binary_shape()
+ *      reads the size of a binary maze from its header without
+ *      reading the payload, for reading the payload a piece at a time
+ * args -
+ *      head - the first bytes of the file
+ *      length - the amount of bytes in head
+ *      size - the size of the file
+ *      width - location to store the cells per row
+ *      height - location to store the amount of rows
+ * returns -
+ *      the offset of the payload in the file, 0 with a message 
+ *      printed to stderr if the header is not valid
+ */
+size_t binary_shape(const char* head, size_t length, size_t size, 
+                int* width, int* height);
+
+/**
+ * map_binary()
+ *      create a maze whose walls are the payload of a mapped binary file,
+ *      the caller records the mapping in the maze so it is unmapped
+ *      when the maze is cleaned
+ * args -
+ *      mapping - the mapped file, writable and private, with a zeroed
+ *              word mapped past its end like an allocated bitmap has
+ *      size - the size of the file
+ * returns -
+ *      a pointer to a maze structure, NULL if the file is not valid
+ */
+Maze map_binary(void* mapping, size_t size);
+
+/**
+ * stream_binary()
+ *      read a binary maze from a stream that can not be mapped
+ * args -
+ *      input - the rest of the stream
+ *      head - bytes already read from the start of the stream
+ *      length - the amount of bytes in head
+ * returns -
+ *      a pointer to a maze structure, NULL if the stream is not valid
+ */
+Maze stream_binary(FILE* input, const char* head, size_t length);
+
+/**
+ * write_binary()
+ *      writes a maze in the binary format
+ * args -
+ *      maze - the maze to write
+ *      output - where to write it
+ * returns -
+ *      0 on success, -1 on a write error or with a message printed
+ *      to stderr if the maze is weighted
+ */
+int write_binary(const Maze maze, FILE* output);
+
+/**
+ * layout_walls()
+ *      copies the wall bitmap of a maze into either layout
+ * args -
+ *      maze - the maze to copy the walls of
+ *      tiled - 1 for the tiled layout, 0 for row major
+ *      words - location to store the words in the copy, may be NULL
+ * returns -
+ *      the copy, with a zeroed word past its end, for the caller to free
+ */
+uint64_t* layout_walls(const Maze maze, int tiled, size_t* words);
+
+/**
+ * hash_words()
+ *      an xxHash64 style hash of an array of words, the padding 
+ *      of every row of a bitmap is clear so equal grids hash equally
+ * args -
+ *      words - the words to hash
+ *      count - the amount of words
+ *      seed - mixed into the hash, so equal words can hash differently
+ * returns -
+ *      the hash
+ */
+uint64_t hash_words(const uint64_t* words, size_t count, uint64_t seed);
+
+/**
+ * prepare_search()
+ *      discards the previous solution and search state of the maze,
+ *      then allocates a cleared visited bitmap and a step map from
+ *      the maze's search arena
+ * args -
+ *      maze - the maze about to be solved
+ */
+void prepare_search(Maze maze);
+
+/**
+ * trace_path()
+ *      marks a path in the solution bitmap by following steps back
+ * args -
+ *      maze - the maze being solved
+ *      steps - the step map to follow
+ *      index - the cell to start from
+ *      stop - the cell the path ends at
+ * returns -
+ *      the amount of cells marked, including index and stop
+ */
+int trace_path(Maze maze, const uint64_t* steps, size_t index, size_t stop);
+
+/**
+ * astar_priority()
+ *      the A* queue priority of a cell
+ * args -
+ *      maze - the maze the cell is in
+ *      index - the cell
+ *      cost - the moves taken to reach the cell (g)
+ * returns -
+ *      the priority of the cell, lowest comes out first
+ */
+uint64_t astar_priority(const Maze maze, size_t index, uint64_t cost);
+
+/**
+ * astar_cost()
+ *      recovers the moves taken to reach a cell from its A* priority
+ * args -
+ *      maze - the maze the cell is in
+ *      index - the cell
+ *      rank - the priority the cell was queued with
+ * returns -
+ *      the moves taken to reach the cell (g)
+ */
+uint64_t astar_cost(const Maze maze, size_t index, uint64_t rank);
+
+/**
+ * solve_bibfs()
+ *      breadth first search from the start and the exit at once
+ * args -
+ *      maze - the maze to solve
+ *      stats - counters to fill in
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_bibfs(Maze maze, SolveStats* stats);
+
+/**
+ * solve_jps()
+ *      A* over jump points only, straight runs with no 
+ *      forced turns are skipped instead of queued cell by cell
+ * args -
+ *      maze - the maze to solve
+ *      stats - counters to fill in
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_jps(Maze maze, SolveStats* stats);
+
+/**
+ * solve_bitbfs()
+ *      breadth first search that advances the frontier a word of
+ *      cells at a time with shifts and masks instead of per cell checks
+ * args -
+ *      maze - the maze to solve
+ *      stats - counters to fill in
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_bitbfs(Maze maze, SolveStats* stats);
+
+/**
+ * solve_dial()
+ *      Dijkstra's search over the costs of a weighted maze with a
+ *      bucket queue, the cost of a path is the sum of its cells' costs
+ * args -
+ *      maze - the maze to solve, with weights
+ *      stats - counters to fill in
+ * returns -
+ *      the cheapest path cost (min: 1), or -1 if there is no solution
+ */
+int solve_dial(Maze maze, SolveStats* stats);
+
+/**
+ * solve_parbfs()
+ *      level synchronous breadth first search with the
+ *      cells of each level split between threads
+ * args -
+ *      maze - the maze to solve
+ *      threads - the amount of threads, below 1 for one per processor
+ *      stats - counters to fill in
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no solution
+ */
+int solve_parbfs(Maze maze, int threads, SolveStats* stats);
+
+#endif // MAZEIMPL
@@ -0,0 +1,323 @@
+/// File: mazejps.c
+/// Description: jump point search on the 4-connected grid.
+///     Shortest paths are kept in a canonical form where vertical moves
+///     come as early as possible, so a horizontal run only turns where a
+///     wall behind it forces the turn and a vertical run only stops where
+///     a horizontal run from it would find something. Only those jump 
+///     points are queued, straight runs are skipped over.
+///     Horizontal runs are scanned a bitmap word (64 cells) at a time.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "pqueueADT.h"
+#include "mazeimpl.h"
+#include "mazestats.h"
+
+#define ALL_WALLS (~(uint64_t)0) /// a word outside the maze
+#define TABLE_RESERVE 1024 /// jump points the cost table has room for at first
+#define NO_COST (~(uint64_t)0) /// cost of a cell that is not in the table
+
+/// a jump point can be reached along each of the four steps and each 
+/// arrival allows different turns, so each is closed on its own
+#define CLOSED(index, step) ((index) * (STEP_RIGHT + 1) + (step))
+
+#define WALL(index) ((index) == NO_CELL || TEST_BIT(maze->walls, (index)))
+#define VERTICAL(step) ((step) == STEP_UP || (step) == STEP_DOWN)
+
+/// one expanded jump point and the moves taken to reach it
+typedef struct JUMP_ST {
+    size_t cell; /// the jump point, NO_CELL for an empty slot
+    uint64_t cost; /// the moves taken to reach the jump point (g)
+} Jump;
+
+/// the cost of every expanded jump point, an open addressed hash table
+/// since jump points are few compared to the cells of the maze
+typedef struct JUMP_TABLE_ST {
+    Jump* slots; /// the table, its size is a power of two
+    size_t capacity; /// the amount of slots
+    size_t num; /// the amount of slots in use
+} JumpTable;
+
+/**
+ * table_slot()
+ *      finds the slot a cell is stored in or would be stored in
+ * args -
+ *      table - the table to search
+ *      index - the cell
+ * returns -
+ *      the slot for the cell
+ */
+static Jump* table_slot(const JumpTable* table, size_t index) {
+    size_t slot = (size_t)(index * 0x9E3779B97F4A7C15ull) & (table->capacity - 1);
+    while(table->slots[slot].cell != NO_CELL && table->slots[slot].cell != index)
+        slot = (slot + 1) & (table->capacity - 1);
+    return &table->slots[slot];
+}
+
+/**
+ * table_grow()
+ *      moves the table into an arena allocation with room for count slots
+ * args -
+ *      arena - where the slots come from
+ *      table - the table to grow
+ *      count - the new amount of slots, a power of two
+ */
+static void table_grow(Arena arena, JumpTable* table, size_t count) {
+    JumpTable grown = {arena_alloc(arena, sizeof(Jump) * count), count, 0};
+    for(size_t slot = 0; slot < count; slot++)
+        grown.slots[slot].cell = NO_CELL;
+    for(size_t slot = 0; slot < table->capacity; slot++)
+        if(table->slots[slot].cell != NO_CELL) {
+            *table_slot(&grown, table->slots[slot].cell) = table->slots[slot];
+            grown.num++;
+        }
+    *table = grown;
+}
+
+/**
+ * table_put()
+ *      records the cost of a jump point, the table is kept at most 
+ *      half full so searches stay short
+ * args -
+ *      arena - where the slots come from
+ *      table - the table to add to
+ *      index - the jump point
+ *      cost - the moves taken to reach it
+ */
+static void table_put(Arena arena, JumpTable* table, size_t index, uint64_t cost) {
+    if(2 * (table->num + 1) > table->capacity)
+        table_grow(arena, table, 2 * table->capacity);
+    Jump* slot = table_slot(table, index);
+    if(slot->cell == NO_CELL) table->num++;
+    slot->cell = index;
+    slot->cost = cost;
+}
+
+/**
+ * table_get()
+ *      looks up the cost of a jump point
+ * args -
+ *      table - the table to search
+ *      index - the jump point
+ * returns -
+ *      the moves taken to reach it, NO_COST if it was never expanded
+ */
+static uint64_t table_get(const JumpTable* table, size_t index) {
+    Jump* slot = table_slot(table, index);
+    return (slot->cell == NO_CELL)?NO_COST:slot->cost;
+}
+
+/**
+ * row_word()
+ *      one word of a row of walls, everything outside the
+ *      maze including the padding past the last column reads as wall
+ * args -
+ *      maze - the maze
+ *      row - the row, may be out of bounds
+ *      word - the word of the row, may be out of bounds
+ * returns -
+ *      the wall bits of the word
+ */
+static uint64_t row_word(const Maze maze, long row, long word) {
+    if(row < 0 || row >= maze->height || word < 0 || word >= (long)maze->stride)
+        return ALL_WALLS;
+    uint64_t bits = maze->walls[row * maze->stride + word];
+    if(word == (long)maze->stride - 1 && maze->width % WORD_BITS)
+        bits |= ALL_WALLS << (maze->width % WORD_BITS);
+    return bits;
+}
+
+/**
+ * jump_horizontal()
+ *      runs along a row until reaching a jump point. A cell is a 
+ *      jump point when it is the exit, or when the cell above or below 
+ *      it is open while the one diagonally behind is a wall, since
+ *      turning there is the only short way around that wall.
+ *      
+ *      forced turns for a whole word are found at once by shifting
+ *      the neighboring rows by one column
+ * args -
+ *      maze - the maze
+ *      index - the cell to run from
+ *      step - STEP_LEFT or STEP_RIGHT
+ *      exit - the exit cell
+ * returns -
+ *      the jump point, or NO_CELL if the run ends at a wall
+ */
+static size_t jump_horizontal(const Maze maze, size_t index, 
+                int step, size_t exit) {
+    long row = ROW(index), column = COLUMN(index);
+    long goal = (ROW(exit) == (size_t)row)?(long)COLUMN(exit):-1;
+
+    if(step == STEP_RIGHT) {
+        long start = column + 1;
+        for(long word = start / WORD_BITS; word < (long)maze->stride; word++) {
+            uint64_t above = row_word(maze, row - 1, word);
+            uint64_t below = row_word(maze, row + 1, word);
+            // bit x of the shifted row is the cell behind x
+            uint64_t behindAbove = (above << 1) | 
+                        (row_word(maze, row - 1, word - 1) >> (WORD_BITS - 1));
+            uint64_t behindBelow = (below << 1) | 
+                        (row_word(maze, row + 1, word - 1) >> (WORD_BITS - 1));
+            uint64_t walls = row_word(maze, row, word);
+            uint64_t stop = walls | (~above & behindAbove) | (~below & behindBelow);
+            if(goal >= 0 && goal / WORD_BITS == word)
+                stop |= (uint64_t)1 << (goal % WORD_BITS);
+            if(word == start / WORD_BITS)
+                stop &= ALL_WALLS << (start % WORD_BITS);
+            if(stop) {
+                int bit = __builtin_ctzll(stop);
+                return ((walls >> bit) & 1)?NO_CELL:
+                        COORDS(row, word * WORD_BITS + bit);
+            }
+        }
+    } else if(column > 0) {
+        long start = column - 1;
+        for(long word = start / WORD_BITS; word >= 0; word--) {
+            uint64_t above = row_word(maze, row - 1, word);
+            uint64_t below = row_word(maze, row + 1, word);
+            uint64_t behindAbove = (above >> 1) | 
+                        (row_word(maze, row - 1, word + 1) << (WORD_BITS - 1));
+            uint64_t behindBelow = (below >> 1) | 
+                        (row_word(maze, row + 1, word + 1) << (WORD_BITS - 1));
+            uint64_t walls = row_word(maze, row, word);
+            uint64_t stop = walls | (~above & behindAbove) | (~below & behindBelow);
+            if(goal >= 0 && goal / WORD_BITS == word)
+                stop |= (uint64_t)1 << (goal % WORD_BITS);
+            if(word == start / WORD_BITS && start % WORD_BITS != WORD_BITS - 1)
+                stop &= ((uint64_t)1 << (start % WORD_BITS + 1)) - 1;
+            if(stop) {
+                int bit = WORD_BITS - 1 - __builtin_clzll(stop);
+                return ((walls >> bit) & 1)?NO_CELL:
+                        COORDS(row, word * WORD_BITS + bit);
+            }
+        }
+    }
+    return NO_CELL;
+}
+
+/**
+ * jump_vertical()
+ *      runs along a column until reaching a jump point, a cell is
+ *      a jump point when it is the exit or when a horizontal run 
+ *      from it finds a jump point
+ * args -
+ *      maze - the maze
+ *      index - the cell to run from
+ *      step - STEP_UP or STEP_DOWN
+ *      exit - the exit cell
+ * returns -
+ *      the jump point, or NO_CELL if the run ends at a wall
+ */
+static size_t jump_vertical(const Maze maze, size_t index, 
+                int step, size_t exit) {
+    for(;;) {
+        index = (step == STEP_UP)?ABOVE(index):BELOW(index);
+        if(WALL(index)) return NO_CELL;
+        if(index == exit ||
+                jump_horizontal(maze, index, STEP_LEFT, exit) != NO_CELL ||
+                jump_horizontal(maze, index, STEP_RIGHT, exit) != NO_CELL)
+            return index;
+    }
+}
+
+/**
+ * forced_turn()
+ *      reports if a cell reached by a horizontal step must be 
+ *      allowed to turn vertically
+ * args -
+ *      maze - the maze
+ *      index - the cell
+ *      arrived - the horizontal step that reached the cell
+ *      turn - STEP_UP or STEP_DOWN
+ * returns -
+ *      1 if the turn is forced, 0 if a shorter canonical path covers it
+ */
+static int forced_turn(const Maze maze, size_t index, int arrived, int turn) {
+    size_t behind = PREVIOUS(index, arrived);
+    size_t side = (turn == STEP_UP)?ABOVE(index):BELOW(index);
+    size_t diagonal = (turn == STEP_UP)?ABOVE(behind):BELOW(behind);
+    return !WALL(side) && WALL(diagonal);
+}
+
+/// Implementation from mazeimpl.h
+/// solve_jps()
+///     A* over jump points only
+int solve_jps(Maze maze, SolveStats* stats) {
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    if(TEST_BIT(maze->walls, 0)) return -1;
+    uint64_t* closed = arena_calloc(maze->search, 
+        maze->words * (STEP_RIGHT + 1) + 1, sizeof(uint64_t));
+    JumpTable costs = {NULL, 0, 0};
+    table_grow(maze->search, &costs, TABLE_RESERVE);
+
+    PQueue next = pq_create_in(maze->search, SEARCH_RESERVE / 16);
+    pq_push(next, astar_priority(maze, 0, 0), ITEM(0, STEP_UP));
+    stats->pushed++;
+
+    int foundExit = 0;
+    while(!pq_empty(next) && !foundExit) {
+        uint64_t rank;
+        uint64_t item = pq_pop(next, &rank);
+        size_t index = ITEM_CELL(item);
+        int arrived = ITEM_STEP(item);
+        if(TEST_BIT(closed, CLOSED(index, arrived))) {
+            STAT_ADD(STAT_STALE_POPS, 1);
+            continue;
+        }
+        SET_BIT(closed, CLOSED(index, arrived));
+        uint64_t g = astar_cost(maze, index, rank);
+        // the first arrival has the least cost, it is the one 
+        // the path is traced back through
+        if(!TEST_BIT(maze->visited, index)) {
+            SET_BIT(maze->visited, index);
+            SET_STEP(maze->steps, index, arrived);
+            table_put(maze->search, &costs, index, g);
+        }
+        stats->expanded++;
+        if(index == exit) {
+            foundExit = 1;
+            break;
+        }
+
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            // the start may go anywhere, vertical arrivals may
+            // go on or turn, horizontal arrivals only go on
+            // unless a wall forces a turn
+            if(index != 0 && !VERTICAL(arrived) && step != arrived && 
+                    (!VERTICAL(step) || !forced_turn(maze, index, arrived, step)))
+                continue;
+            if(index != 0 && step == (arrived ^ 1)) continue; // no going back
+            size_t jump = VERTICAL(step)?jump_vertical(maze, index, step, exit):
+                            jump_horizontal(maze, index, step, exit);
+            if(jump == NO_CELL || TEST_BIT(closed, CLOSED(jump, step))) continue;
+            uint64_t length = (VERTICAL(step))?
+                (ROW(jump) > ROW(index)?ROW(jump) - ROW(index):ROW(index) - ROW(jump)):
+                (jump > index?jump - index:index - jump);
+            pq_push(next, astar_priority(maze, jump, g + length), ITEM(jump, step));
+            stats->pushed++;
+        }
+    }
+    if(!foundExit) return -1;
+
+    // runs between jump points are straight, so walk back one cell 
+    // at a time. A run can cross other jump points, only turn onto
+    // one whose cost matches the moves left, which holds for the 
+    // jump point the run started at and for any other just as short
+    size_t index = exit;
+    uint64_t left = table_get(&costs, exit);
+    int step = GET_STEP(maze->steps, exit), cells = 1;
+    SET_BIT(maze->path, index);
+    while(index != 0) {
+        index = PREVIOUS(index, step);
+        left--;
+        if(TEST_BIT(maze->visited, index) && table_get(&costs, index) == left)
+            step = GET_STEP(maze->steps, index);
+        SET_BIT(maze->path, index);
+        cells++;
+    }
+    return cells;
+}
@@ -0,0 +1,164 @@
+/// File: mazelabel.c
+/// Description: labels the connected regions of open cells. Each row is
+///     cut into runs of open cells straight from the wall bitmap, a run
+///     is joined with every run it touches in the row above through
+///     union find, and the cells of each run are then given the label
+///     of the region its run ended up in
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+/// the runs of open cells found so far, row by row
+typedef struct {
+    uint32_t* start; /// the first column of each run
+    uint32_t* end; /// the column after the last of each run
+    uint32_t* parent; /// the run each run was joined to, itself for a root
+    size_t num; /// the amount of runs
+    size_t capacity; /// the amount of runs there is room for
+} Runs;
+
+/**
+ * next_cell()
+ *      finds the next cell of a row that is open, or that is a wall
+ * args -
+ *      row - the words of the row, row major
+ *      from - the column to start looking at
+ *      width - the amount of cells in the row
+ *      open - 1 to look for an open cell, 0 to look for a wall
+ * returns -
+ *      the column of the cell, or width if there is none
+ */
+static int next_cell(const uint64_t* row, int from, int width, int open) {
+    if(from >= width) return width;
+    size_t word = (size_t)from / WORD_BITS;
+    // the walls are set bits, so an open cell is a set bit when flipped
+    uint64_t bits = (open)?~row[word]:row[word];
+    bits &= ~(uint64_t)0 << (from % WORD_BITS);
+    while(!bits) {
+        if(++word * WORD_BITS >= (size_t)width) return width;
+        bits = (open)?~row[word]:row[word];
+    }
+    size_t found = word * WORD_BITS + __builtin_ctzll(bits);
+    return (found < (size_t)width)?(int)found:width;
+}
+
+/**
+ * find_root()
+ *      finds the run at the root of a run's region, halving the
+ *      path to it along the way
+ */
+static uint32_t find_root(uint32_t* parent, uint32_t run) {
+    while(parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+/**
+ * add_run()
+ *      adds a run of open cells as a region of its own
+ * args -
+ *      runs - the runs so far, grown as needed
+ *      start - the first column of the run
+ *      end - the column after the last of the run
+ */
+static void add_run(Runs* runs, int start, int end) {
+    if(runs->num == runs->capacity) {
+        runs->capacity = (runs->capacity)?runs->capacity * 2:1024;
+        assert(runs->capacity < UINT32_MAX);
+        runs->start = realloc(runs->start, sizeof(uint32_t) * runs->capacity);
+        runs->end = realloc(runs->end, sizeof(uint32_t) * runs->capacity);
+        runs->parent = realloc(runs->parent,
+                            sizeof(uint32_t) * runs->capacity);
+        assert(runs->start != NULL && runs->end != NULL &&
+                runs->parent != NULL);
+    }
+    runs->start[runs->num] = start;
+    runs->end[runs->num] = end;
+    runs->parent[runs->num] = runs->num;
+    runs->num++;
+}
+
+/// Implementation from maze.h
+/// label_maze()
+///     finds which open cells of a maze are connected to each other
+size_t label_maze(Maze maze) {
+    if(maze->labels != NULL) return maze->regions;
+    int width = maze->width, height = maze->height;
+    size_t stride = (width + WORD_BITS - 1) / WORD_BITS;
+    uint64_t* walls = (maze->tiled)?layout_walls(maze, 0, NULL):maze->walls;
+
+    // the runs of row y are first[y] up to first[y + 1]
+    Runs runs;
+    memset(&runs, 0, sizeof(Runs));
+    size_t* first = malloc(sizeof(size_t) * (height + 1));
+    assert(first != NULL);
+    for(int y = 0; y < height; y++) {
+        const uint64_t* row = walls + y * stride;
+        first[y] = runs.num;
+        size_t above = (y)?first[y - 1]:first[y];
+        for(int x = next_cell(row, 0, width, 1); x < width;
+                x = next_cell(row, x, width, 1)) {
+            int end = next_cell(row, x, width, 0);
+            uint32_t run = runs.num;
+            add_run(&runs, x, end);
+            // runs above that end before this one can't touch later ones
+            while(above < first[y] && runs.end[above] <= (uint32_t)x) above++;
+            for(size_t touch = above; touch < first[y] &&
+                    runs.start[touch] < (uint32_t)end; touch++) {
+                uint32_t a = find_root(runs.parent, run);
+                uint32_t b = find_root(runs.parent, touch);
+                // the earlier run stays the root so roots come in order
+                if(a < b) runs.parent[b] = a; else runs.parent[a] = b;
+            }
+            x = end;
+        }
+    }
+    first[height] = runs.num;
+    if(walls != maze->walls) free(walls);
+
+    // the roots become labels 1, 2, ... in the order they were found,
+    // a root always comes before the runs joined to it so its label
+    // is known by the time they look it up
+    maze->labels = calloc((size_t)width * height + 1, sizeof(uint32_t));
+    assert(maze->labels != NULL);
+    for(size_t run = 0; run < runs.num; run++)
+        runs.parent[run] = find_root(runs.parent, run);
+    uint32_t regions = 0;
+    for(size_t run = 0; run < runs.num; run++)
+        runs.parent[run] = (runs.parent[run] == run)?++regions:
+                                runs.parent[runs.parent[run]];
+    for(int y = 0; y < height; y++)
+        for(size_t run = first[y]; run < first[y + 1]; run++)
+            for(uint32_t x = runs.start[run]; x < runs.end[run]; x++)
+                maze->labels[(size_t)y * width + x] = runs.parent[run];
+    free(first);
+    free(runs.start);
+    free(runs.end);
+    free(runs.parent);
+    maze->regions = regions;
+    return regions;
+}
+
+/// Implementation from maze.h
+/// maze_connected()
+///     checks whether there is a path between two cells
+int maze_connected(const Maze maze, int fromRow, int fromColumn,
+                int toRow, int toColumn) {
+    if(fromRow < 0 || fromRow >= maze->height || fromColumn < 0 ||
+            fromColumn >= maze->width || toRow < 0 ||
+            toRow >= maze->height || toColumn < 0 || toColumn >= maze->width)
+        return 0;
+    label_maze(maze);
+    uint32_t from = maze->labels[(size_t)fromRow * maze->width + fromColumn];
+    return from &&
+            from == maze->labels[(size_t)toRow * maze->width + toColumn];
+}
@@ -0,0 +1,303 @@
+/// File: mazeparbfs.c
+/// Description: level synchronous breadth first search split across
+///     threads. Workers take chunks of a level, claim the cells they
+///     reach with atomic operations and collect them in their own
+///     buffers, the buffers are merged into the next level at a barrier.
+///     Levels too small to be worth splitting are run by one thread.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazeimpl.h"
+
+#define FRONTIER_RESERVE 1024 /// cells a level has room for at first
+#define PARALLEL_MIN 2048 /// smallest level split across the threads
+#define CHUNK_CELLS 256 /// cells a worker takes from a level at once
+
+/// cells found by one worker on the current level
+typedef struct BUFFER_ST {
+    size_t* cells; /// the cells found
+    size_t num; /// the amount of cells found
+    size_t capacity; /// the amount of cells there is room for
+} Buffer;
+
+/// state shared by every worker of a search
+typedef struct SHARED_ST {
+    Maze maze; /// the maze being solved
+    size_t exit; /// the cell being searched for
+    pthread_mutex_t gate; /// held while the workers are started
+    pthread_barrier_t barrier; /// separates the phases of a level
+    int threads; /// the amount of workers running
+    size_t* level; /// the cells being expanded
+    size_t levelNum; /// the amount of cells being expanded
+    size_t levelCapacity; /// the amount of cells level has room for
+    size_t* next; /// the cells of the next level
+    size_t nextCapacity; /// the amount of cells next has room for
+    size_t claim; /// the first cell of the level not yet taken
+    int found; /// set once the exit has been reached
+    int done; /// set once the search is over
+} Shared;
+
+/// one thread of a search
+typedef struct WORKER_ST {
+    Shared* shared; /// the search the worker is part of
+    pthread_t thread; /// the thread running the worker
+    int id; /// the worker's place in the merged level
+    Buffer found; /// cells this worker found on the current level
+    SolveStats stats; /// counters for this worker
+} Worker;
+
+/**
+ * buffer_add()
+ *      add a cell to a worker's buffer, growing it when full
+ * args -
+ *      buffer - the buffer to add to
+ *      index - the cell to add
+ */
+static void buffer_add(Buffer* buffer, size_t index) {
+    if(buffer->num == buffer->capacity) {
+        buffer->capacity = (buffer->capacity)?buffer->capacity * 2:
+                                FRONTIER_RESERVE;
+        buffer->cells = realloc(buffer->cells,
+                                sizeof(size_t) * buffer->capacity);
+        if(buffer->cells == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    buffer->cells[buffer->num++] = index;
+}
+
+/**
+ * claim_cell()
+ *      marks a cell visited unless another worker got there first
+ * args -
+ *      maze - the maze being solved
+ *      index - the cell to claim
+ *      step - the step taken into the cell
+ * returns -
+ *      1 if this call claimed the cell, 0 otherwise
+ */
+static int claim_cell(Maze maze, size_t index, int step) {
+    uint64_t bit = (uint64_t)1 << (index % WORD_BITS);
+    if(__atomic_fetch_or(&maze->visited[index / WORD_BITS], bit,
+                __ATOMIC_RELAXED) & bit)
+        return 0;
+    // other workers write the other cells of the step word
+    size_t word = index / (WORD_BITS / STEP_BITS);
+    int shift = index % (WORD_BITS / STEP_BITS) * STEP_BITS;
+    __atomic_fetch_and(&maze->steps[word], ~((uint64_t)3 << shift),
+                __ATOMIC_RELAXED);
+    __atomic_fetch_or(&maze->steps[word], (uint64_t)step << shift,
+                __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ * expand_cells()
+ *      expands part of a level into a worker's buffer
+ * args -
+ *      worker - the worker doing the expanding
+ *      start - the first cell of the level to expand
+ *      end - one past the last cell to expand
+ */
+static void expand_cells(Worker* worker, size_t start, size_t end) {
+    Shared* shared = worker->shared;
+    Maze maze = shared->maze;
+    for(size_t c = start; c < end; c++) {
+        size_t index = shared->level[c];
+        size_t neighbors[] = {ABOVE(index), BELOW(index),
+                                LEFT(index), RIGHT(index)};
+        worker->stats.expanded++;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            size_t neighbor = neighbors[step];
+            if(neighbor == NO_CELL || TEST_BIT(maze->walls, neighbor) ||
+                    (__atomic_load_n(&maze->visited[neighbor / WORD_BITS],
+                        __ATOMIC_RELAXED) >> (neighbor % WORD_BITS) & 1) ||
+                    !claim_cell(maze, neighbor, step))
+                continue;
+            buffer_add(&worker->found, neighbor);
+            worker->stats.pushed++;
+            if(neighbor == shared->exit)
+                __atomic_store_n(&shared->found, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * next_level()
+ *      makes room for the next level, called by one worker at a time
+ * args -
+ *      shared - the search
+ *      cells - the amount of cells the next level may hold
+ */
+static void next_level(Shared* shared, size_t cells) {
+    if(cells <= shared->nextCapacity) return;
+    // the old level is released with the arena
+    while(shared->nextCapacity < cells)
+        shared->nextCapacity *= 2;
+    shared->next = arena_alloc(shared->maze->search,
+                        sizeof(size_t) * shared->nextCapacity);
+}
+
+/**
+ * swap_levels()
+ *      makes the next level the one being expanded
+ * args -
+ *      shared - the search
+ *      cells - the amount of cells in the next level
+ */
+static void swap_levels(Shared* shared, size_t cells) {
+    size_t* level = shared->level;
+    size_t capacity = shared->levelCapacity;
+    shared->level = shared->next;
+    shared->levelCapacity = shared->nextCapacity;
+    shared->next = level;
+    shared->nextCapacity = capacity;
+    shared->levelNum = cells;
+    shared->claim = 0;
+}
+
+/**
+ * serial_levels()
+ *      expands levels on the first worker alone while they are
+ *      too small to be worth splitting, the others wait at the barrier
+ * args -
+ *      worker - the first worker
+ */
+static void serial_levels(Worker* worker) {
+    Shared* shared = worker->shared;
+    while(!shared->found && shared->levelNum &&
+            (shared->levelNum < PARALLEL_MIN || shared->threads == 1)) {
+        worker->found.num = 0;
+        expand_cells(worker, 0, shared->levelNum);
+        next_level(shared, worker->found.num);
+        if(worker->found.num)
+            memcpy(shared->next, worker->found.cells,
+                    sizeof(size_t) * worker->found.num);
+        swap_levels(shared, worker->found.num);
+    }
+    shared->done = shared->found || !shared->levelNum;
+    // a cell adds at most four cells to the next level, so every
+    // worker can copy its buffer in without another allocation
+    if(!shared->done) next_level(shared, 4 * shared->levelNum);
+}
+
+/**
+ * run_worker()
+ *      the loop every worker runs, one pass per level split across them
+ * args -
+ *      data - the Worker to run
+ * returns -
+ *      NULL
+ */
+static void* run_worker(void* data) {
+    Worker* worker = data;
+    Worker* workers = worker - worker->id;
+    Shared* shared = worker->shared;
+    // wait for the barrier to be set up for the workers that started
+    pthread_mutex_lock(&shared->gate);
+    pthread_mutex_unlock(&shared->gate);
+
+    for(;;) {
+        if(worker->id == 0) serial_levels(worker);
+        pthread_barrier_wait(&shared->barrier);
+        if(shared->done) break;
+
+        size_t start;
+        worker->found.num = 0;
+        while((start = __atomic_fetch_add(&shared->claim, CHUNK_CELLS,
+                    __ATOMIC_RELAXED)) < shared->levelNum) {
+            size_t end = start + CHUNK_CELLS;
+            expand_cells(worker, start,
+                    (end < shared->levelNum)?end:shared->levelNum);
+        }
+        pthread_barrier_wait(&shared->barrier);
+
+        // the buffers are merged in worker order
+        size_t offset = 0, cells = 0;
+        for(int w = 0; w < shared->threads; w++) {
+            if(w == worker->id) offset = cells;
+            cells += workers[w].found.num;
+        }
+        if(worker->found.num)
+            memcpy(shared->next + offset, worker->found.cells,
+                    sizeof(size_t) * worker->found.num);
+        pthread_barrier_wait(&shared->barrier);
+        if(worker->id == 0) swap_levels(shared, cells);
+    }
+    return NULL;
+}
+
+/// Implementation from mazeimpl.h
+/// solve_parbfs()
+///     breadth first search with each level split across threads
+int solve_parbfs(Maze maze, int threads, SolveStats* stats) {
+    size_t exit = COORDS(maze->height - 1, maze->width - 1);
+    if(TEST_BIT(maze->walls, 0)) return -1;
+    if(threads < 1) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(threads < 1) threads = 1;
+
+    Shared shared;
+    memset(&shared, 0, sizeof(Shared));
+    shared.maze = maze;
+    shared.exit = exit;
+    shared.level = arena_alloc(maze->search,
+                        sizeof(size_t) * FRONTIER_RESERVE);
+    shared.next = arena_alloc(maze->search,
+                        sizeof(size_t) * FRONTIER_RESERVE);
+    shared.levelCapacity = FRONTIER_RESERVE;
+    shared.nextCapacity = FRONTIER_RESERVE;
+    shared.level[0] = 0;
+    shared.levelNum = 1;
+    shared.found = (exit == 0);
+    SET_BIT(maze->visited, 0);
+    stats->pushed++;
+
+    Worker* workers = calloc(threads, sizeof(Worker));
+    if(workers == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    // workers that fail to start are left out of the barrier
+    pthread_mutex_init(&shared.gate, NULL);
+    pthread_mutex_lock(&shared.gate);
+    int started = 1;
+    for(int w = 0; w < threads; w++) {
+        workers[w].shared = &shared;
+        workers[w].id = w;
+    }
+    for(; started < threads; started++) {
+        if(pthread_create(&workers[started].thread, NULL,
+                    run_worker, &workers[started])) {
+            perror("pthread_create");
+            break;
+        }
+    }
+    shared.threads = started;
+    pthread_barrier_init(&shared.barrier, NULL, started);
+    pthread_mutex_unlock(&shared.gate);
+
+    run_worker(&workers[0]);
+    for(int w = 0; w < started; w++) {
+        if(w) pthread_join(workers[w].thread, NULL);
+        stats->expanded += workers[w].stats.expanded;
+        stats->pushed += workers[w].stats.pushed;
+        free(workers[w].found.cells);
+    }
+    free(workers);
+    pthread_barrier_destroy(&shared.barrier);
+    pthread_mutex_destroy(&shared.gate);
+
+    if(!TEST_BIT(maze->visited, exit)) return -1;
+    return trace_path(maze, maze->steps, exit, 0);
+}
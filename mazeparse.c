@@ -0,0 +1,170 @@
+/// File: mazeparse.c
+/// Description: implementation of mazeparse.h,
+///     rows are decoded 16 cells at a time with SSE2 or 
+///     32 cells at a time with AVX2 when the compiler targets them,
+///     rows with weighted cells one cell at a time
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BLOCK_CELLS 32 /// cells decoded by one vector step
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BLOCK_CELLS 16 /// cells decoded by one vector step
+#else
+#define BLOCK_CELLS 0 /// no vector step, every cell is decoded by parse_tail()
+#endif
+
+#include "mazeparse.h"
+#include "mazestats.h"
+
+#define WORD_BITS 64 /// cells packed into one bitmap word
+
+#if BLOCK_CELLS
+/**
+ * parse_block()
+ *      decodes BLOCK_CELLS cells from 2 * BLOCK_CELLS characters.
+ *      The cell characters sit on even offsets and the seperators
+ *      on odd offsets, so the even and odd bytes are packed
+ *      into their own vectors and compared all at once.
+ * args -
+ *      text - the first character of the block
+ *      bits - location to store one bit per cell, set for walls
+ * returns -
+ *      1 if every cell was '0' or '1' and every seperator a space, 
+ *      0 otherwise
+ */
+static int parse_block(const char* text, uint64_t* bits) {
+#if defined(__AVX2__)
+    const __m256i low = _mm256_set1_epi16(0x00FF);
+    __m256i first = _mm256_loadu_si256((const __m256i*)text);
+    __m256i second = _mm256_loadu_si256((const __m256i*)(text + 32));
+    // packs work within 128 bit lanes, put the quarters back in order
+    __m256i cells = _mm256_permute4x64_epi64(_mm256_packus_epi16(
+        _mm256_and_si256(first, low), _mm256_and_si256(second, low)), 0xD8);
+    __m256i seperators = _mm256_permute4x64_epi64(_mm256_packus_epi16(
+        _mm256_srli_epi16(first, 8), _mm256_srli_epi16(second, 8)), 0xD8);
+    uint32_t ones = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(cells, _mm256_set1_epi8('1')));
+    uint32_t zeros = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(cells, _mm256_set1_epi8('0')));
+    uint32_t spaces = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(seperators, _mm256_set1_epi8(' ')));
+    *bits = ones;
+    return ((ones | zeros) & spaces) == 0xFFFFFFFFu;
+#else
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    __m128i first = _mm_loadu_si128((const __m128i*)text);
+    __m128i second = _mm_loadu_si128((const __m128i*)(text + 16));
+    __m128i cells = _mm_packus_epi16(
+        _mm_and_si128(first, low), _mm_and_si128(second, low));
+    __m128i seperators = _mm_packus_epi16(
+        _mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8));
+    int ones = _mm_movemask_epi8(_mm_cmpeq_epi8(cells, _mm_set1_epi8('1')));
+    int zeros = _mm_movemask_epi8(_mm_cmpeq_epi8(cells, _mm_set1_epi8('0')));
+    int spaces = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(seperators, _mm_set1_epi8(' ')));
+    *bits = (uint64_t)ones;
+    return ((ones | zeros) & spaces) == 0xFFFF;
+#endif
+}
+#endif
+
+/**
+ * parse_tail()
+ *      decodes cells one character at a time, used for the
+ *      cells that do not fill a vector step and to find the
+ *      exact character that made a vector step fail
+ * args -
+ *      text - the start of the row
+ *      length - the amount of characters available from text
+ *      column - the first cell to decode
+ *      width - the amount of cells in the row
+ *      row - the words of the row
+ * returns -
+ *      PARSE_OK or the offset of the first invalid character
+ */
+static size_t parse_tail(const char* text, size_t length, 
+                int column, int width, uint64_t* row) {
+    uint64_t word = row[column / WORD_BITS] & 
+                    (((uint64_t)1 << (column % WORD_BITS)) - 1);
+    for(; column < width; column++) {
+        size_t offset = 2 * (size_t)column;
+        if(offset >= length) return length;
+        if(text[offset] != '0' && text[offset] != '1') return offset;
+        word |= (uint64_t)(text[offset] == '1') << (column % WORD_BITS);
+
+        // every cell but the last is followed by a space, 
+        // the last is followed by a newline or the end of the text
+        char expect = (column + 1 < width)?' ':'\n';
+        if(offset + 1 < length && text[offset + 1] != expect) 
+            return offset + 1;
+        if(offset + 1 >= length && expect == ' ') return length;
+
+        if(column % WORD_BITS == WORD_BITS - 1) {
+            row[column / WORD_BITS] = word;
+            word = 0;
+        }
+    }
+    if(width % WORD_BITS) row[width / WORD_BITS] = word;
+    return PARSE_OK;
+}
+
+/// Implementation from mazeparse.h
+/// parse_row()
+///     validates one row of text and packs its cells into words
+size_t parse_row(const char* text, size_t length, int width, uint64_t* row) {
+    int column = 0;
+    STAT_ADD(STAT_ROWS_PARSED, 1);
+#if BLOCK_CELLS
+    // only whole blocks followed by at least one more cell are decoded
+    // here, so every seperator in a block is a space and the
+    // newline is left to parse_tail()
+    if(length >= 2 * (size_t)width - 1) {
+        uint64_t word = 0;
+        for(; column + BLOCK_CELLS < width; column += BLOCK_CELLS) {
+            uint64_t bits;
+            if(!parse_block(text + 2 * (size_t)column, &bits)) break;
+            word |= bits << (column % WORD_BITS);
+            if((column + BLOCK_CELLS) % WORD_BITS == 0) {
+                row[column / WORD_BITS] = word;
+                word = 0;
+            }
+        }
+        row[column / WORD_BITS] = word;
+    }
+#endif
+    return parse_tail(text, length, column, width, row);
+}
+
+/// Implementation from mazeparse.h
+/// parse_weights()
+///     validates one row of text with weighted cells and packs its cells
+size_t parse_weights(const char* text, size_t length, int width, 
+                uint64_t* row, uint8_t* weights) {
+    uint64_t word = 0;
+    for(int column = 0; column < width; column++) {
+        size_t offset = 2 * (size_t)column;
+        if(offset >= length) return length;
+        char cell = text[offset];
+        if(cell < '0' || cell > '0' + MAX_WEIGHT) return offset;
+        word |= (uint64_t)(cell == '1') << (column % WORD_BITS);
+        weights[column] = (cell > '1')?cell - '0':1;
+
+        char expect = (column + 1 < width)?' ':'\n';
+        if(offset + 1 < length && text[offset + 1] != expect) 
+            return offset + 1;
+        if(offset + 1 >= length && expect == ' ') return length;
+
+        if(column % WORD_BITS == WORD_BITS - 1) {
+            row[column / WORD_BITS] = word;
+            word = 0;
+        }
+    }
+    if(width % WORD_BITS) row[width / WORD_BITS] = word;
+    return PARSE_OK;
+}
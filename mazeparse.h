@@ -0,0 +1,57 @@
+/// File: mazeparse.h
+/// Description: decoding of the text maze format into packed rows
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifndef MAZEPARSE
+#define MAZEPARSE
+
+#define PARSE_OK ((size_t)-1) /// returned by parse_row() for a valid row
+#define MAX_WEIGHT 9 /// the largest cost a weighted cell may have
+
+/**
+ * parse_row()
+ *      validates one row of the text maze format and packs its cells 
+ *      into bitmap words, one bit per cell with walls set.
+ *
+ *      a row of width cells is exactly 2 * width characters, 
+ *      a '0' or '1' for each cell seperated by spaces and 
+ *      terminated by a newline. The final row of a file may 
+ *      leave out its newline. 
+ *
+ *      bits of the last word past width are cleared.
+ * args -
+ *      text - the start of the row
+ *      length - the amount of characters available from text
+ *      width - the amount of cells in the row
+ *      row - (width + 63) / 64 words to store the row in
+ * returns -
+ *      PARSE_OK if the row is valid, otherwise the offset of
+ *      the first invalid character (length if the row is cut short)
+ */
+size_t parse_row(const char* text, size_t length, int width, uint64_t* row);
+
+/**
+ * parse_weights()
+ *      parse_row() for a row that may hold weighted cells, a digit from
+ *      '2' to MAX_WEIGHT is an open cell costing that much to move into.
+ *      '0' is an open cell costing 1 and '1' a wall, whose cost is 
+ *      stored as 1. Rows are read one character at a time, so this is
+ *      only used on rows parse_row() stopped at a weighted cell
+ * args -
+ *      text - the start of the row
+ *      length - the amount of characters available from text
+ *      width - the amount of cells in the row
+ *      row - (width + 63) / 64 words to store the row in
+ *      weights - width bytes to store the cost of each cell in
+ * returns -
+ *      PARSE_OK if the row is valid, otherwise the offset of
+ *      the first invalid character (length if the row is cut short)
+ */
+size_t parse_weights(const char* text, size_t length, int width, 
+                uint64_t* row, uint8_t* weights);
+
+#endif // MAZEPARSE
@@ -0,0 +1,243 @@
+/// File: mazeplan.c
+/// Description: implementation of mazeplan.h with lifelong planning A*.
+///     Every cell keeps g, the distance the search last settled on, and
+///     rhs, the distance its neighbors' g values offer it. A cell whose
+///     two values differ is inconsistent and queued; a toggled cell only
+///     makes itself and its neighbors inconsistent, and the repair stops
+///     once nothing queued could shorten or lengthen the path to the goal
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "pqueueADT.h"
+#include "mazeimpl.h"
+#include "mazeplan.h"
+
+#define NO_DISTANCE UINT32_MAX /// g or rhs of a cell the start can't reach
+#define STALE_LIMIT 4 /// queue entries allowed per cell before requeueing
+
+struct PLAN_ST {
+    Maze maze; /// the maze being solved
+    size_t start; /// the cell paths start at
+    size_t goal; /// the cell paths end at
+    int goalRow, goalColumn;
+    uint32_t* g; /// the distance from the start the search settled on
+    uint32_t* rhs; /// the distance offered by the neighbors of each cell
+    size_t cells; /// the size of g and rhs, every cell of the bitmaps
+    PQueue open; /// the inconsistent cells, entries are never removed
+                 /// so a cell may have stale entries behind its current one
+};
+
+/**
+ * plan_key()
+ *      the queue priority of a cell, the smaller of g and rhs plus the
+ *      distance left to the goal, ties broken by the smaller of g and rhs
+ * args -
+ *      plan - the planner
+ *      index - the cell
+ * returns -
+ *      the priority, NO_DISTANCE in both halves for a cell not reached
+ */
+static uint64_t plan_key(const Planner plan, size_t index) {
+    const Maze maze = plan->maze;
+    uint32_t best = (plan->g[index] < plan->rhs[index])?plan->g[index]:
+                        plan->rhs[index];
+    if(best == NO_DISTANCE) return UINT64_MAX;
+    int row = (int)ROW(index), column = (int)COLUMN(index);
+    uint64_t left = (uint64_t)abs(row - plan->goalRow) +
+                        abs(column - plan->goalColumn);
+    return ((best + left) << 32) | best;
+}
+
+/**
+ * update_cell()
+ *      recomputes the rhs of a cell and queues it if it is inconsistent
+ * args -
+ *      plan - the planner
+ *      index - the cell, NO_CELL is ignored
+ *      stats - counters to update
+ */
+static void update_cell(Planner plan, size_t index, SolveStats* stats) {
+    const Maze maze = plan->maze;
+    if(index == NO_CELL) return;
+    if(index != plan->start) {
+        uint32_t best = NO_DISTANCE;
+        if(!TEST_BIT(maze->walls, index)) {
+            size_t neighbors[] = {ABOVE(index), BELOW(index),
+                                    LEFT(index), RIGHT(index)};
+            for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+                size_t neighbor = neighbors[step];
+                // a wall keeps its g until the repair reaches it
+                if(neighbor == NO_CELL || TEST_BIT(maze->walls, neighbor) ||
+                        plan->g[neighbor] == NO_DISTANCE)
+                    continue;
+                if(plan->g[neighbor] + 1 < best) best = plan->g[neighbor] + 1;
+            }
+        }
+        plan->rhs[index] = best;
+    }
+    if(plan->g[index] != plan->rhs[index]) {
+        pq_push(plan->open, plan_key(plan, index), index);
+        stats->pushed++;
+    }
+}
+
+/**
+ * update_around()
+ *      recomputes a cell and its neighbors after the cell changed
+ * args -
+ *      plan - the planner
+ *      index - the cell
+ *      stats - counters to update
+ */
+static void update_around(Planner plan, size_t index, SolveStats* stats) {
+    const Maze maze = plan->maze;
+    size_t neighbors[] = {ABOVE(index), BELOW(index),
+                            LEFT(index), RIGHT(index)};
+    update_cell(plan, index, stats);
+    for(int step = STEP_UP; step <= STEP_RIGHT; step++)
+        update_cell(plan, neighbors[step], stats);
+}
+
+/**
+ * requeue()
+ *      rebuilds the queue from the inconsistent cells, dropping the
+ *      stale entries left behind by earlier repairs
+ * args -
+ *      plan - the planner
+ */
+static void requeue(Planner plan) {
+    pq_clear(plan->open);
+    for(size_t index = 0; index < plan->cells; index++)
+        if(plan->g[index] != plan->rhs[index])
+            pq_push(plan->open, plan_key(plan, index), index);
+}
+
+/**
+ * repair()
+ *      settles inconsistent cells until the goal is consistent and
+ *      nothing queued comes before it
+ * args -
+ *      plan - the planner
+ *      stats - counters to update
+ */
+static void repair(Planner plan, SolveStats* stats) {
+    while(!pq_empty(plan->open)) {
+        uint64_t key;
+        size_t index = pq_peek(plan->open, &key);
+        if(key >= plan_key(plan, plan->goal) &&
+                plan->g[plan->goal] == plan->rhs[plan->goal])
+            break;
+        pq_pop(plan->open, NULL);
+        // an entry is current only if the cell still has that key,
+        // a cell whose key changed was queued again when it did
+        if(plan->g[index] == plan->rhs[index] || key != plan_key(plan, index))
+            continue;
+        stats->expanded++;
+        // a cell that got closer settles, one that got further away is
+        // unsettled until its neighbors offer it a new distance
+        plan->g[index] = (plan->g[index] > plan->rhs[index])?
+                            plan->rhs[index]:NO_DISTANCE;
+        update_around(plan, index, stats);
+    }
+}
+
+/// Implementation from mazeplan.h
+/// plan_create()
+///     readies incremental solving of a maze
+Planner plan_create(Maze maze, int startRow, int startColumn,
+                int goalRow, int goalColumn) {
+    if(startRow < 0 || startRow >= maze->height || startColumn < 0 ||
+            startColumn >= maze->width || goalRow < 0 ||
+            goalRow >= maze->height || goalColumn < 0 ||
+            goalColumn >= maze->width)
+        return NULL;
+    Planner plan = malloc(sizeof(struct PLAN_ST));
+    assert(plan != NULL);
+    plan->maze = maze;
+    plan->start = COORDS(startRow, startColumn);
+    plan->goal = COORDS(goalRow, goalColumn);
+    plan->goalRow = goalRow;
+    plan->goalColumn = goalColumn;
+    plan->cells = maze->words * WORD_BITS;
+    plan->g = malloc(sizeof(uint32_t) * plan->cells);
+    plan->rhs = malloc(sizeof(uint32_t) * plan->cells);
+    assert(plan->g != NULL && plan->rhs != NULL);
+    memset(plan->g, 0xff, sizeof(uint32_t) * plan->cells);
+    memset(plan->rhs, 0xff, sizeof(uint32_t) * plan->cells);
+    plan->open = pq_create(SEARCH_RESERVE / 16);
+
+    // the first solve is an A* search from the start
+    plan->rhs[plan->start] = 0;
+    pq_push(plan->open, plan_key(plan, plan->start), plan->start);
+    return plan;
+}
+
+/// Implementation from mazeplan.h
+/// plan_destroy()
+///     free all memory held by a planner
+void plan_destroy(Planner plan) {
+    if(plan == NULL) return;
+    free(plan->g);
+    free(plan->rhs);
+    pq_destroy(plan->open);
+    free(plan);
+}
+
+/// Implementation from mazeplan.h
+/// plan_toggle()
+///     turns an open cell into a wall or a wall into an open cell
+int plan_toggle(Planner plan, int row, int column) {
+    const Maze maze = plan->maze;
+    if(row < 0 || row >= maze->height || column < 0 || column >= maze->width)
+        return -1;
+    size_t index = COORDS(row, column);
+    maze->walls[index / WORD_BITS] ^= (uint64_t)1 << (index % WORD_BITS);
+    // the regions may have been split or joined
+    free(maze->labels);
+    maze->labels = NULL;
+    SolveStats ignored = {0, 0};
+    update_around(plan, index, &ignored);
+    return (int)TEST_BIT(maze->walls, index);
+}
+
+/// Implementation from mazeplan.h
+/// plan_solve()
+///     repairs the search and marks the shortest path
+int plan_solve(Planner plan, SolveStats* stats) {
+    Maze maze = plan->maze;
+    SolveStats counted = {0, 0};
+    if(pq_size(plan->open) > STALE_LIMIT * (size_t)maze->width * maze->height)
+        requeue(plan);
+    repair(plan, &counted);
+    if(stats != NULL) *stats = counted;
+
+    prepare_search(maze);
+    if(TEST_BIT(maze->walls, plan->start) ||
+            plan->g[plan->goal] == NO_DISTANCE)
+        return -1;
+    // every cell on a shortest path is consistent, so stepping to the
+    // neighbor nearest the start walks one back to it
+    size_t index = plan->goal;
+    SET_BIT(maze->path, index);
+    while(index != plan->start) {
+        size_t neighbors[] = {ABOVE(index), BELOW(index),
+                                LEFT(index), RIGHT(index)};
+        size_t nearest = NO_CELL;
+        for(int step = STEP_UP; step <= STEP_RIGHT; step++) {
+            size_t neighbor = neighbors[step];
+            if(neighbor == NO_CELL || TEST_BIT(maze->walls, neighbor)) continue;
+            if(nearest == NO_CELL || plan->g[neighbor] < plan->g[nearest])
+                nearest = neighbor;
+        }
+        assert(nearest != NO_CELL && plan->g[nearest] < plan->g[index]);
+        index = nearest;
+        SET_BIT(maze->path, index);
+    }
+    return (int)plan->g[plan->goal] + 1;
+}
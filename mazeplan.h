@@ -0,0 +1,66 @@
+/// File: mazeplan.h
+/// Description: incremental solving of a maze whose cells change between
+///     solves. A planner keeps the state of its search (lifelong planning
+///     A*) across edits, so after a few cells are toggled only the part of
+///     the search those cells affected is repaired
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <sys/types.h>
+#include "maze.h"
+
+#ifndef MAZEPLAN
+#define MAZEPLAN
+
+/// represent the search state of one maze between one start and one goal
+typedef struct PLAN_ST* Planner;
+
+/**
+ * plan_create()
+ *      readies incremental solving of a maze, the maze must outlive
+ *      the planner and keep its layout while the planner is in use
+ * args -
+ *      maze - the maze to solve, its cells are changed by plan_toggle()
+ *      startRow, startColumn - the cell paths start at
+ *      goalRow, goalColumn - the cell paths end at
+ * returns -
+ *      the planner, or NULL if either cell is outside the maze
+ */
+Planner plan_create(Maze maze, int startRow, int startColumn,
+                int goalRow, int goalColumn);
+
+/**
+ * plan_destroy()
+ *      free all memory held by a planner, the maze is left as it is
+ * args -
+ *      plan - the planner to free
+ */
+void plan_destroy(Planner plan);
+
+/**
+ * plan_toggle()
+ *      turns an open cell of the planner's maze into a wall or a wall
+ *      into an open cell, the search is repaired by the next plan_solve()
+ * args -
+ *      plan - the planner
+ *      row, column - the cell to change
+ * returns -
+ *      1 if the cell is now a wall, 0 if it is now open,
+ *      -1 if it is outside the maze
+ */
+int plan_toggle(Planner plan, int row, int column);
+
+/**
+ * plan_solve()
+ *      brings the search up to date with the cells toggled since the
+ *      last solve and marks the shortest path in the maze's solution
+ *      bitmap, any previous solution is discarded
+ * args -
+ *      plan - the planner
+ *      stats - location to store the counters of the repair, may be NULL
+ * returns -
+ *      the shortest path distance (min: 1), or -1 if there is no path
+ */
+int plan_solve(Planner plan, SolveStats* stats);
+
+#endif // MAZEPLAN
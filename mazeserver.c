@@ -0,0 +1,701 @@
+/// File: mazeserver.c
+/// Description: a long running solver listening on a unix domain socket.
+///     An epoll loop accepts connections and reads them until a whole
+///     request line has arrived, then queues the connection for a pool
+///     of workers started once. A worker answers every request buffered
+///     and hands the connection back to the loop, each worker keeps its
+///     maze, workspace and drawing buffer between requests.
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include "mazeserver.h"
+
+#define LISTEN_BACKLOG 128 /// connections the kernel holds before accept
+#define MAX_PAYLOAD ((size_t)1 << 28) /// largest MAZE request accepted
+#define KEEP_CELLS ((size_t)1 << 24) /// largest maze a worker keeps the memory of
+#define KEEP_DRAWING ((size_t)1 << 24) /// largest drawing buffer a worker keeps
+#define SERVER_EVENTS 64 /// events taken from epoll at once
+#define DRAIN_CHUNK 4096 /// bytes of a rejected payload skipped at once
+
+/// epoll data of the sockets that are not connections
+#define LISTENER_EVENT SERVER_CONNECTIONS
+#define STOP_EVENT (SERVER_CONNECTIONS + 1)
+
+/// an open connection, owned by the epoll loop unless busy
+typedef struct CONNECTION_ST {
+    int fd; /// the socket, -1 when the slot is free
+    int busy; /// set while queued for or served by a worker
+    int hungUp; /// set once the client has sent everything
+    time_t active; /// when the client was last heard from or answered
+    size_t length; /// bytes in buffer
+    char buffer[SERVER_LINE]; /// bytes received, starting at the next request
+} Connection;
+
+/// the connections and the requests waiting for a worker
+typedef struct SERVER_ST {
+    Connection* connections; /// SERVER_CONNECTIONS slots
+    int open; /// the amount of slots in use
+    int queue[SERVER_CONNECTIONS]; /// slots with a request, oldest at head
+    size_t head; /// the next slot to hand out
+    size_t num; /// the amount of slots waiting
+    int accepting; /// set while the listener is armed in epoll
+    int closed; /// set once the server is shutting down
+    int events; /// the epoll instance
+    int listener; /// the listening socket
+    pthread_mutex_t lock;
+    pthread_cond_t ready; /// signalled when a request is queued
+} Server;
+
+/// one thread of the pool, its buffers live as long as the server
+typedef struct WORKER_ST {
+    Server* server; /// where requests come from
+    Solver solver; /// the search strategy to solve with
+    SolveCache cache; /// solutions to reuse, may be NULL
+    pthread_t thread; /// the thread running the worker
+    char line[SERVER_LINE]; /// the request being answered
+    Maze maze; /// the last maze read, its memory is reused by the next
+    Workspace work; /// the search and path of every solve
+    char* drawing; /// the drawing of the last solved maze
+    size_t drawingSize; /// the size of drawing
+    FILE* canvas; /// a stream writing into drawing, NULL if it can't be made
+} Worker;
+
+/// a MAZE payload read as the maze is parsed
+typedef struct PAYLOAD_ST {
+    Connection* connection; /// the connection the payload arrives on
+    size_t start; /// bytes of the connection's buffer already read
+    size_t left; /// bytes of the payload not yet read
+    int broken; /// set if the client stopped before the end
+} Payload;
+
+/**
+ * arm()
+ *      asks epoll for the next event of a socket, every socket is
+ *      registered one shot so only one thread handles it at a time
+ * args -
+ *      server - the server
+ *      fd - the socket
+ *      data - what the event reports, the slot of a connection
+ *      op - EPOLL_CTL_ADD for a new socket, EPOLL_CTL_MOD to re-arm
+ * returns -
+ *      0 on success, -1 on error
+ */
+static int arm(Server* server, int fd, uint64_t data, int op) {
+    struct epoll_event event = {.events = EPOLLIN | EPOLLONESHOT};
+    event.data.u64 = data;
+    return epoll_ctl(server->events, op, fd, &event);
+}
+
+/**
+ * close_connection()
+ *      closes a connection and frees its slot, the listener is armed
+ *      again if it was left off for lack of a slot. Called with the lock
+ * args -
+ *      server - the server
+ *      connection - the connection to close
+ */
+static void close_connection(Server* server, Connection* connection) {
+    close(connection->fd); // also removes it from epoll
+    connection->fd = -1;
+    connection->busy = connection->hungUp = 0;
+    connection->length = 0;
+    server->open--;
+    if(!server->accepting && !server->closed &&
+            !arm(server, server->listener, LISTENER_EVENT, EPOLL_CTL_MOD))
+        server->accepting = 1;
+}
+
+/**
+ * send_all()
+ *      writes a whole buffer to a connection, waiting up to
+ *      SERVER_IDLE seconds each time the client reads nothing
+ * args -
+ *      fd - the connection
+ *      buffer - the bytes to send
+ *      size - the amount of bytes
+ * returns -
+ *      0 on success, -1 if the client went away or stopped reading
+ */
+static int send_all(int fd, const char* buffer, size_t size) {
+    struct pollfd wait = {.fd = fd, .events = POLLOUT};
+    while(size) {
+        ssize_t sent = send(fd, buffer, size, MSG_NOSIGNAL);
+        if(sent > 0) {
+            buffer += sent;
+            size -= sent;
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            if(poll(&wait, 1, SERVER_IDLE * 1000) == 0) return -1;
+        } else if(errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * receive()
+ *      reads what has arrived on a connection, waiting up to
+ *      SERVER_IDLE seconds when nothing has
+ * args -
+ *      fd - the connection
+ *      buffer - location to store the bytes
+ *      size - the most bytes to read
+ * returns -
+ *      the amount of bytes read, 0 when the client hung up,
+ *      -1 on error or when the client sent nothing
+ */
+static ssize_t receive(int fd, char* buffer, size_t size) {
+    struct pollfd wait = {.fd = fd, .events = POLLIN};
+    for(;;) {
+        ssize_t got = recv(fd, buffer, size, 0);
+        if(got >= 0) return got;
+        if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            if(poll(&wait, 1, SERVER_IDLE * 1000) == 0) return -1;
+        } else if(errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * read_payload()
+ *      the read function of a payload stream, the bytes buffered with
+ *      the request line come first and the rest is read as it arrives
+ * args -
+ *      cookie - the Payload
+ *      buffer - location to store the bytes
+ *      size - the most bytes to read
+ * returns -
+ *      the amount of bytes read, 0 at the end of the payload, -1 on error
+ */
+static ssize_t read_payload(void* cookie, char* buffer, size_t size) {
+    Payload* payload = cookie;
+    Connection* connection = payload->connection;
+    if(payload->broken) return -1; // stdio retries a failed read
+    if(size > payload->left) size = payload->left;
+    if(!size) return 0;
+    ssize_t got;
+    if(payload->start < connection->length) {
+        got = connection->length - payload->start;
+        if((size_t)got > size) got = size;
+        memcpy(buffer, connection->buffer + payload->start, got);
+        payload->start += got;
+    } else if((got = receive(connection->fd, buffer, size)) <= 0) {
+        payload->broken = 1;
+        return got;
+    }
+    payload->left -= got;
+    return got;
+}
+
+/**
+ * load_payload()
+ *      reads the maze of a MAZE request. The payload is parsed as it
+ *      arrives and whatever is left after a malformed maze is skipped,
+ *      so the request after it is read from the right place
+ * args -
+ *      worker - the worker serving the request
+ *      connection - the connection the payload arrives on
+ *      length - the size of the payload
+ *      error - location to store a reason when no maze is returned
+ *      broken - set when the connection has to be closed
+ * returns -
+ *      the maze, or NULL
+ */
+static Maze load_payload(Worker* worker, Connection* connection,
+                size_t length, const char** error, int* broken) {
+    Payload payload = {.connection = connection, .start = 0, .left = length};
+    cookie_io_functions_t functions = {.read = read_payload};
+    FILE* source = fopencookie(&payload, "r", functions);
+    if(source == NULL) {
+        *error = "out of memory";
+        *broken = 1; // the payload is left unread
+        return NULL;
+    }
+    Maze maze = reload_maze(worker->maze, source);
+    worker->maze = NULL;
+    char skipped[DRAIN_CHUNK];
+    while(fread(skipped, 1, DRAIN_CHUNK, source) == DRAIN_CHUNK);
+    fclose(source);
+
+    connection->length -= payload.start;
+    memmove(connection->buffer, connection->buffer + payload.start,
+            connection->length);
+    if(payload.broken || payload.left) {
+        clean_maze(maze); // the maze only covers part of the payload
+        *error = "payload cut short";
+        *broken = 1;
+        return NULL;
+    }
+    if(maze == NULL) *error = "not a valid maze";
+    return maze;
+}
+
+/**
+ * load_request()
+ *      reads the maze named by a request
+ * args -
+ *      worker - the worker serving the request
+ *      connection - the connection, for the payload of MAZE requests
+ *      request - the request line after any PATH prefix
+ *      error - location to store a reason when no maze is returned
+ *      broken - set when the connection has to be closed
+ * returns -
+ *      the maze, or NULL
+ */
+static Maze load_request(Worker* worker, Connection* connection,
+                const char* request, const char** error, int* broken) {
+    if(!strncmp(request, "MAZE ", 5)) {
+        char* end;
+        size_t length = strtoull(request + 5, &end, 10);
+        if(end == request + 5 || *end || !length || length > MAX_PAYLOAD) {
+            // the payload can't be skipped without its length
+            *error = "bad payload length";
+            *broken = 1;
+            return NULL;
+        }
+        return load_payload(worker, connection, length, error, broken);
+    }
+    if(strncmp(request, "FILE ", 5)) {
+        *error = "unknown request";
+        return NULL;
+    }
+    FILE* source = fopen(request + 5, "r");
+    if(source == NULL) {
+        *error = "cannot open file";
+        return NULL;
+    }
+    Maze maze = reload_maze(worker->maze, source);
+    worker->maze = NULL;
+    fclose(source);
+    if(maze == NULL) *error = "not a valid maze";
+    return maze;
+}
+
+/**
+ * draw()
+ *      draws a solved maze into the worker's drawing buffer
+ * args -
+ *      worker - the worker
+ *      maze - the maze solved in the worker's workspace
+ * returns -
+ *      the size of the drawing, or -1 if it could not be made
+ */
+static off_t draw(Worker* worker, const Maze maze) {
+    if(worker->canvas == NULL)
+        worker->canvas = open_memstream(&worker->drawing, &worker->drawingSize);
+    if(worker->canvas == NULL) return -1;
+    fseeko(worker->canvas, 0, SEEK_SET);
+    print_solution(maze, worker->work, worker->canvas);
+    if(fflush(worker->canvas)) return -1;
+    return ftello(worker->canvas);
+}
+
+/**
+ * shrink()
+ *      frees what a worker holds beyond what an ordinary request needs,
+ *      so one large request does not keep its memory for the server's life
+ * args -
+ *      worker - the worker
+ */
+static void shrink(Worker* worker) {
+    if(worker->maze != NULL && (size_t)maze_width(worker->maze) *
+                maze_height(worker->maze) > KEEP_CELLS) {
+        clean_maze(worker->maze);
+        worker->maze = NULL;
+        workspace_destroy(worker->work);
+        worker->work = workspace_create();
+    }
+    if(worker->canvas != NULL && worker->drawingSize > KEEP_DRAWING) {
+        fclose(worker->canvas);
+        free(worker->drawing);
+        worker->drawing = NULL;
+        worker->drawingSize = 0;
+        worker->canvas = open_memstream(&worker->drawing, &worker->drawingSize);
+    }
+}
+
+/**
+ * serve_request()
+ *      answers the first request buffered on a connection
+ * args -
+ *      worker - the worker serving the connection
+ *      connection - the connection, with a whole request line buffered
+ * returns -
+ *      0 on success, -1 if the connection has to be closed
+ */
+static int serve_request(Worker* worker, Connection* connection) {
+    char* newline = memchr(connection->buffer, '\n', connection->length);
+    size_t length = newline - connection->buffer;
+    memcpy(worker->line, connection->buffer, length);
+    worker->line[length] = '\0';
+    connection->length -= length + 1;
+    memmove(connection->buffer, newline + 1, connection->length);
+
+    const char* request = worker->line;
+    int draw_path = !strncmp(request, "PATH ", 5);
+    if(draw_path) request += 5;
+
+    const char* error = NULL;
+    int broken = 0;
+    Maze maze = load_request(worker, connection, request, &error, &broken);
+    off_t drawn = 0;
+    if(maze != NULL) {
+        int steps = (worker->cache != NULL)?
+            cache_solve_in(worker->cache, maze, worker->work,
+                    worker->solver, NULL):
+            solve_maze_in(maze, worker->work, worker->solver, NULL);
+        if(draw_path) drawn = draw(worker, maze);
+        worker->maze = maze;
+        if(drawn < 0) error = "cannot draw the maze";
+        else snprintf(worker->line, SERVER_LINE, "OK %i %lld\n",
+                    (steps > 0)?steps:-1, (long long)drawn);
+    }
+    if(error != NULL) snprintf(worker->line, SERVER_LINE, "ERROR %s\n", error);
+    int failed = send_all(connection->fd, worker->line, strlen(worker->line)) ||
+            (error == NULL && send_all(connection->fd, worker->drawing, drawn));
+    shrink(worker);
+    return (failed || broken)?-1:0;
+}
+
+/**
+ * queue_pop()
+ *      takes the oldest connection with a request, waiting while there
+ *      is none
+ * args -
+ *      server - the server
+ * returns -
+ *      the slot of the connection, or -1 once the server is closed
+ *      and every request queued has been taken
+ */
+static int queue_pop(Server* server) {
+    pthread_mutex_lock(&server->lock);
+    while(!server->num && !server->closed)
+        pthread_cond_wait(&server->ready, &server->lock);
+    int slot = -1;
+    if(server->num) {
+        slot = server->queue[server->head];
+        server->head = (server->head + 1) % SERVER_CONNECTIONS;
+        server->num--;
+    }
+    pthread_mutex_unlock(&server->lock);
+    return slot;
+}
+
+/**
+ * run_worker()
+ *      answers queued requests until the server is closed
+ * args -
+ *      data - the Worker to run
+ * returns -
+ *      NULL
+ */
+static void* run_worker(void* data) {
+    Worker* worker = data;
+    Server* server = worker->server;
+    int slot;
+    while((slot = queue_pop(server)) >= 0) {
+        Connection* connection = &server->connections[slot];
+        int failed = 0;
+        while(!failed && memchr(connection->buffer, '\n', connection->length))
+            failed = serve_request(worker, connection);
+
+        // the loop reads the rest of the next request
+        pthread_mutex_lock(&server->lock);
+        if(failed || connection->hungUp || server->closed) {
+            close_connection(server, connection);
+        } else {
+            connection->busy = 0;
+            connection->active = time(NULL);
+            if(arm(server, connection->fd, slot, EPOLL_CTL_MOD))
+                close_connection(server, connection);
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+    return NULL;
+}
+
+/**
+ * accept_clients()
+ *      accepts the connections waiting on the listener while a slot
+ *      is free, the listener is left off once every slot is in use
+ * args -
+ *      server - the server
+ */
+static void accept_clients(Server* server) {
+    pthread_mutex_lock(&server->lock);
+    int failed = 0;
+    while(server->open < SERVER_CONNECTIONS) {
+        int fd = accept4(server->listener, NULL, NULL,
+                        SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) {
+            // out of descriptors, retried once a connection closes
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept");
+                failed = 1;
+            }
+            break;
+        }
+        int slot = 0;
+        while(server->connections[slot].fd >= 0) slot++;
+        Connection* connection = &server->connections[slot];
+        if(arm(server, fd, slot, EPOLL_CTL_ADD)) {
+            perror("epoll_ctl");
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->active = time(NULL);
+        server->open++;
+    }
+    server->accepting = !failed && server->open < SERVER_CONNECTIONS &&
+            !arm(server, server->listener, LISTENER_EVENT, EPOLL_CTL_MOD);
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * read_client()
+ *      reads what has arrived on a connection, it is queued once
+ *      a whole request line is buffered
+ * args -
+ *      server - the server
+ *      slot - the slot of the connection
+ */
+static void read_client(Server* server, int slot) {
+    static const char tooLong[] = "ERROR request too long\n";
+    pthread_mutex_lock(&server->lock);
+    Connection* connection = &server->connections[slot];
+    if(connection->fd < 0 || connection->busy) { // closed since the event
+        pthread_mutex_unlock(&server->lock);
+        return;
+    }
+    ssize_t got = recv(connection->fd, connection->buffer + connection->length,
+                    SERVER_LINE - connection->length, 0);
+    if(got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        if(arm(server, connection->fd, slot, EPOLL_CTL_MOD))
+            close_connection(server, connection);
+        pthread_mutex_unlock(&server->lock);
+        return;
+    }
+    if(got > 0) {
+        connection->length += got;
+        connection->active = time(NULL);
+    } else if(got == 0) {
+        // a last request without a newline is still answered
+        connection->hungUp = 1;
+        if(connection->length && connection->length < SERVER_LINE &&
+                connection->buffer[connection->length - 1] != '\n')
+            connection->buffer[connection->length++] = '\n';
+    }
+
+    if(got >= 0 && memchr(connection->buffer, '\n', connection->length)) {
+        connection->busy = 1;
+        server->queue[(server->head + server->num++) % SERVER_CONNECTIONS] = slot;
+        pthread_cond_signal(&server->ready);
+    } else if(got < 0 || connection->hungUp) {
+        close_connection(server, connection);
+    } else if(connection->length == SERVER_LINE) {
+        send(connection->fd, tooLong, sizeof(tooLong) - 1,
+                MSG_NOSIGNAL | MSG_DONTWAIT);
+        close_connection(server, connection);
+    } else if(arm(server, connection->fd, slot, EPOLL_CTL_MOD)) {
+        close_connection(server, connection);
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * close_idle()
+ *      closes the connections not heard from in SERVER_IDLE seconds
+ *      and retries a listener that failed to accept
+ * args -
+ *      server - the server
+ */
+static void close_idle(Server* server) {
+    time_t now = time(NULL);
+    pthread_mutex_lock(&server->lock);
+    for(int slot = 0; slot < SERVER_CONNECTIONS; slot++) {
+        Connection* connection = &server->connections[slot];
+        if(connection->fd >= 0 && !connection->busy &&
+                now - connection->active >= SERVER_IDLE)
+            close_connection(server, connection);
+    }
+    if(!server->accepting && server->open < SERVER_CONNECTIONS &&
+            !arm(server, server->listener, LISTENER_EVENT, EPOLL_CTL_MOD))
+        server->accepting = 1;
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * close_server()
+ *      stops taking requests: idle connections are closed and those
+ *      with a worker shut for reading, so only the requests already
+ *      read are answered
+ * args -
+ *      server - the server
+ */
+static void close_server(Server* server) {
+    pthread_mutex_lock(&server->lock);
+    server->closed = 1;
+    for(int slot = 0; slot < SERVER_CONNECTIONS; slot++) {
+        Connection* connection = &server->connections[slot];
+        if(connection->fd >= 0 && connection->busy)
+            shutdown(connection->fd, SHUT_RD);
+        else if(connection->fd >= 0)
+            close_connection(server, connection);
+    }
+    pthread_cond_broadcast(&server->ready);
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * open_socket()
+ *      creates a listening unix domain socket
+ * args -
+ *      path - where to create the socket
+ * returns -
+ *      the socket, or -1 on error
+ */
+static int open_socket(const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if(bind(fd, (struct sockaddr*)&address, sizeof(address)) ||
+            listen(fd, LISTEN_BACKLOG)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Implementation from mazeserver.h
+/// serve_mazes()
+///     listens on a unix domain socket and answers requests
+int serve_mazes(const char* path, Solver solver, int workers,
+                SolveCache cache) {
+    if(workers < 1) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(workers < 1) workers = 1;
+
+    // the signals are read from the epoll loop instead of a handler
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    sigdelset(&signals, SIGPIPE);
+
+    Server server;
+    memset(&server, 0, sizeof(Server));
+    server.listener = open_socket(path);
+    if(server.listener < 0) return -1;
+    int stop = signalfd(-1, &signals, SFD_CLOEXEC);
+    server.events = epoll_create1(EPOLL_CLOEXEC);
+    if(stop < 0 || server.events < 0 ||
+            arm(&server, server.listener, LISTENER_EVENT, EPOLL_CTL_ADD)) {
+        perror("epoll");
+        if(stop >= 0) close(stop);
+        if(server.events >= 0) close(server.events);
+        close(server.listener);
+        unlink(path);
+        return -1;
+    }
+    // the stop signal is never disarmed
+    struct epoll_event event = {.events = EPOLLIN};
+    event.data.u64 = STOP_EVENT;
+    epoll_ctl(server.events, EPOLL_CTL_ADD, stop, &event);
+    server.accepting = 1;
+
+    server.connections = calloc(SERVER_CONNECTIONS, sizeof(Connection));
+    Worker* pool = calloc(workers, sizeof(Worker));
+    if(server.connections == NULL || pool == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for(int slot = 0; slot < SERVER_CONNECTIONS; slot++)
+        server.connections[slot].fd = -1;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.ready, NULL);
+    int started = 0;
+    for(; started < workers; started++) {
+        Worker* worker = &pool[started];
+        worker->server = &server;
+        worker->solver = solver;
+        worker->cache = cache;
+        worker->work = workspace_create();
+        worker->canvas = open_memstream(&worker->drawing, &worker->drawingSize);
+        if(worker->canvas == NULL ||
+                pthread_create(&worker->thread, NULL, run_worker, worker)) {
+            perror("worker");
+            if(worker->canvas != NULL) fclose(worker->canvas);
+            free(worker->drawing);
+            workspace_destroy(worker->work);
+            break;
+        }
+    }
+
+    int running = started > 0;
+    while(running) {
+        struct epoll_event ready[SERVER_EVENTS];
+        // wakes every second to close idle connections
+        int count = epoll_wait(server.events, ready, SERVER_EVENTS, 1000);
+        if(count < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        for(int e = 0; e < count; e++) {
+            if(ready[e].data.u64 == STOP_EVENT) running = 0;
+            else if(ready[e].data.u64 == LISTENER_EVENT) accept_clients(&server);
+            else read_client(&server, (int)ready[e].data.u64);
+        }
+        close_idle(&server);
+    }
+
+    // requests already read are still answered, on connections
+    // being served and those queued
+    close_server(&server);
+    for(int w = 0; w < started; w++) {
+        pthread_join(pool[w].thread, NULL);
+        if(pool[w].canvas != NULL) fclose(pool[w].canvas);
+        free(pool[w].drawing);
+        clean_maze(pool[w].maze);
+        workspace_destroy(pool[w].work);
+    }
+    free(pool);
+    free(server.connections);
+    pthread_cond_destroy(&server.ready);
+    pthread_mutex_destroy(&server.lock);
+    close(server.events);
+    close(stop);
+    close(server.listener);
+    unlink(path);
+    return (started > 0)?0:-1;
+}
@@ -0,0 +1,52 @@
+/// File: mazeserver.h
+/// Description: a long running solver listening on a unix domain socket.
+///
+///     A client sends one request per line and may send many requests
+///     on one connection:
+///         FILE path       solve the maze stored at path
+///         MAZE length     solve the length bytes of maze text that
+///                         follow the newline, at most 256 MiB
+///     either request may be prefixed with PATH, as in "PATH FILE path",
+///     to have the solved maze drawn by pretty_print_maze() returned.
+///
+///     every request is answered with one line
+///         OK steps length     steps is -1 when there is no solution,
+///                             followed by length bytes of drawing
+///         ERROR message       the request or its maze was not valid
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include "maze.h"
+#include "mazecache.h"
+
+#ifndef MAZESERVER
+#define MAZESERVER
+
+#define SERVER_CONNECTIONS 256 /// connections held open at once
+#define SERVER_LINE 4096 /// longest request line, with its newline
+#define SERVER_IDLE 30 /// seconds a connection may wait on its client
+
+/**
+ * serve_mazes()
+ *      listens on a unix domain socket and answers requests until
+ *      SIGINT or SIGTERM is received. Requests are queued rather than
+ *      connections: a worker of the pool takes a connection only once
+ *      a whole request line has arrived and hands it back after
+ *      answering, so any amount of idle clients share the workers.
+ *      While SERVER_CONNECTIONS are open no more are accepted, leaving
+ *      clients in the socket's backlog. A connection whose client sends
+ *      or reads nothing for SERVER_IDLE seconds is closed, as is one
+ *      whose request line is longer than SERVER_LINE. On shutdown the
+ *      requests already read are answered and every connection closed.
+ * args -
+ *      path - where to create the socket, removed on exit
+ *      solver - the search strategy to solve with
+ *      workers - the size of the pool, below 1 uses one per processor
+ *      cache - solutions to reuse and add to, may be NULL
+ * returns -
+ *      0 after a clean shutdown, -1 if the socket could not be set up
+ */
+int serve_mazes(const char* path, Solver solver, int workers, 
+                SolveCache cache);
+
+#endif // MAZESERVER
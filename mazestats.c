@@ -0,0 +1,44 @@
+/// File: mazestats.c
+/// Description: implementation of mazestats.h
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "mazestats.h"
+
+#ifdef MAZE_STATS
+__thread uint64_t maze_stats[STAT_COUNT];
+
+/// the name each count is written under, in the order of MazeStat
+static const char* STAT_NAMES[] = {
+    "rows_parsed", "stale_pops", "queue_pushes", "queue_pops",
+    "sift_levels", "queue_peak", "arena_allocs", "arena_bytes",
+    "blocks", "block_bytes", "cells_printed"
+};
+#endif
+
+/// Implementation from mazestats.h
+/// stats_reset()
+///     sets every count of the calling thread back to 0
+void stats_reset(void) {
+    #ifdef MAZE_STATS
+    memset(maze_stats, 0, sizeof(maze_stats));
+    #endif
+}
+
+/// Implementation from mazestats.h
+/// stats_write()
+///     writes the counts of the calling thread as a JSON object
+void stats_write(FILE* output) {
+    #ifdef MAZE_STATS
+    fprintf(output, "{");
+    for(int stat = 0; stat < STAT_COUNT; stat++)
+        fprintf(output, "%s\"%s\": %llu", (stat)?", ":"", STAT_NAMES[stat],
+                (unsigned long long)maze_stats[stat]);
+    fprintf(output, "}");
+    #else
+    fprintf(output, "null");
+    #endif
+}
@@ -0,0 +1,58 @@
+/// File: mazestats.h
+/// Description: counters on the hot paths of parsing, solving and
+///     printing a maze. They are only compiled in when MAZE_STATS is
+///     defined, e.g. make CPPFLAGS=-DMAZE_STATS, otherwise every STAT_
+///     macro is empty and the hot paths are the same as without them.
+///     Each thread counts on its own so counting never needs a lock
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef MAZESTATS
+#define MAZESTATS
+
+/// the things counted, see STAT_NAMES in mazestats.c for how each is reported
+typedef enum {
+    STAT_ROWS_PARSED,   /// text rows decoded by parse_row()
+    STAT_STALE_POPS,    /// queue entries popped for a cell already expanded
+    STAT_QUEUE_PUSHES,  /// entries pushed on any priority queue
+    STAT_QUEUE_POPS,    /// entries popped from any priority queue
+    STAT_SIFT_LEVELS,   /// heap levels entries moved through on push and pop
+    STAT_QUEUE_PEAK,    /// the most entries one priority queue held
+    STAT_ARENA_ALLOCS,  /// allocations made from arenas
+    STAT_ARENA_BYTES,   /// bytes allocated from arenas
+    STAT_BLOCKS,        /// blocks arenas requested from the system
+    STAT_BLOCK_BYTES,   /// bytes of those blocks
+    STAT_CELLS_PRINTED, /// cells written by pretty_print_maze()
+    STAT_COUNT
+} MazeStat;
+
+#ifdef MAZE_STATS
+extern __thread uint64_t maze_stats[STAT_COUNT]; /// the calling thread's counts
+
+#define STAT_ADD(stat, amount) ((void)(maze_stats[stat] += (amount)))
+#define STAT_MAX(stat, value) ((void)(maze_stats[stat] < (value) && \
+                                (maze_stats[stat] = (value))))
+#else
+#define STAT_ADD(stat, amount) ((void)0)
+#define STAT_MAX(stat, value) ((void)0)
+#endif
+
+/**
+ * stats_reset()
+ *      sets every count of the calling thread back to 0
+ */
+void stats_reset(void);
+
+/**
+ * stats_write()
+ *      writes the counts of the calling thread as a JSON object of
+ *      names and counts, or null when the counters are compiled out
+ * args -
+ *      output - where to write the object
+ */
+void stats_write(FILE* output);
+
+#endif // MAZESTATS
@@ -0,0 +1,1001 @@
+/// file: mopbench.c
+/// description: microbenchmarks for the maze solver and its data structures,
+///     results are printed as CSV rows of
+///     benchmark,variant,input,size,seconds,rate,expanded,pushed,
+///     cache_misses,tlb_misses,peak_rss_kb
+///     where peak_rss_kb is the most memory the process had resident
+///     up to that row
+/// author: Nicholas R. Chieppa
+///
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include "HeapADT.h"
+#include "pqueueADT.h"
+#include "queueADT.h"
+#include "stackADT.h"
+#include "maze.h"
+#include "mazeband.h"
+#include "mazegen.h"
+#include "mazehpa.h"
+#include "mazeplan.h"
+
+#define HEAP_ITEMS 1000000 /// default amount of items pushed by heap benchmarks
+#define MAZE_SIZE 1000 /// default width and height of generated mazes
+#define OPEN_DENSITY 10 /// percent of cells that are walls in an open maze
+#define WIDE_WIDTH 65536 /// default width of the mazes compared by layout
+#define WIDE_HEIGHT 256 /// default height of the mazes compared by layout
+#define HPA_QUERIES 1000 /// default amount of queries answered by hpa
+#define FIELD_QUERIES 1000 /// default amount of starts answered by field
+#define PLAN_ROUNDS 20 /// default amount of edit batches solved by plan
+#define SHARED_ROUNDS 20 /// default amount of solves each thread of shared runs
+#define SUITE_ITEMS 1000000 /// items pushed by the data structure part of suite
+#define BAND_WIDTH 801 /// default width of the mazes solved in bands
+#define BAND_HEIGHT 400 /// default height of the mazes solved in bands
+#define BAND_LIMIT 400000 /// default memory limit of band, about a tenth
+                          /// of the default mazes in each band
+
+/// the solvers compared by the solver benchmarks
+static const struct {
+    const char* name;
+    Solver solver;
+} SOLVERS[] = {
+    {"greedy", SOLVE_GREEDY},
+    {"astar", SOLVE_ASTAR},
+    {"bibfs", SOLVE_BIBFS},
+    {"jps", SOLVE_JPS},
+    {"bitbfs", SOLVE_BITBFS},
+    {"parbfs", SOLVE_PARBFS},
+    {"dial", SOLVE_DIAL},
+};
+#define SOLVER_COUNT (sizeof(SOLVERS) / sizeof(SOLVERS[0]))
+
+/// the solvers that walk single cells, so run the same on both layouts
+static const struct {
+    const char* name;
+    Solver solver;
+} CELL_SOLVERS[] = {
+    {"greedy", SOLVE_GREEDY},
+    {"astar", SOLVE_ASTAR},
+    {"bibfs", SOLVE_BIBFS},
+};
+#define CELL_SOLVER_COUNT (sizeof(CELL_SOLVERS) / sizeof(CELL_SOLVERS[0]))
+
+/// hardware counters read around a benchmark, -1 when the 
+/// kernel or machine does not provide them
+typedef struct {
+    long long cache; /// last level cache misses
+    long long tlb; /// data TLB read misses
+} Misses;
+
+/// open hardware counters
+typedef struct {
+    int cache; /// counts last level cache misses
+    int tlb; /// counts data TLB read misses
+} Probe;
+
+/**
+ * now()
+ *      reads a monotonic clock
+ * returns -
+ *      the current time in seconds
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * open_counter()
+ *      opens a hardware counter for this process, stopped
+ * args -
+ *      type - the perf event type
+ *      config - the perf event
+ * returns -
+ *      the counter, or -1 if it is not available
+ */
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * probe_start()
+ *      opens and starts the cache and TLB miss counters
+ * args -
+ *      probe - the counters to start
+ */
+static void probe_start(Probe* probe) {
+    probe->cache = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    probe->tlb = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) | 
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    if(probe->cache >= 0) ioctl(probe->cache, PERF_EVENT_IOC_ENABLE, 0);
+    if(probe->tlb >= 0) ioctl(probe->tlb, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+/**
+ * probe_stop()
+ *      stops and closes the counters
+ * args -
+ *      probe - the counters to stop
+ *      misses - location to store what was counted
+ */
+static void probe_stop(Probe* probe, Misses* misses) {
+    int fds[] = {probe->cache, probe->tlb};
+    long long* counts[] = {&misses->cache, &misses->tlb};
+    for(int c = 0; c < 2; c++) {
+        *counts[c] = -1;
+        if(fds[c] < 0) continue;
+        ioctl(fds[c], PERF_EVENT_IOC_DISABLE, 0);
+        if(read(fds[c], counts[c], sizeof(long long)) != sizeof(long long))
+            *counts[c] = -1;
+        close(fds[c]);
+    }
+}
+
+/**
+ * report()
+ *      prints one CSV row of results
+ * args -
+ *      benchmark - the name of the benchmark
+ *      variant - what was measured
+ *      input - what it was measured on
+ *      size - the size of the problem
+ *      seconds - time taken
+ *      work - the amount of operations done, rate is work per second
+ *      stats - search counters, NULL when not a solve
+ *      misses - hardware counters, NULL when not measured
+ */
+static void report(const char* benchmark, const char* variant, 
+                const char* input, size_t size, double seconds, double work,
+                const SolveStats* stats, const Misses* misses) {
+    printf("%s,%s,%s,%zu,%.6f,%.0f,", benchmark, variant, input, size, 
+            seconds, (seconds > 0)?work / seconds:0);
+    if(stats != NULL)
+        printf("%lu,%lu,", stats->expanded, stats->pushed);
+    else
+        printf(",,");
+    if(misses != NULL && misses->cache >= 0) printf("%lld", misses->cache);
+    printf(",");
+    if(misses != NULL && misses->tlb >= 0) printf("%lld", misses->tlb);
+    struct rusage usage;
+    if(!getrusage(RUSAGE_SELF, &usage)) printf(",%ld", usage.ru_maxrss);
+    else printf(",");
+    printf("\n");
+}
+
+/// an item queued in HeapADT, allocated the same way solve_maze once did
+typedef struct BENCH_NODE_ST {
+    uint64_t priority;
+    uint64_t item;
+} Node;
+
+static int cmpNodes(const void* lhs, const void* rhs) {
+    return ((const Node*)lhs)->priority < ((const Node*)rhs)->priority;
+}
+
+static void dumpNode(const void* item, FILE* outfp) {
+    fprintf(outfp, "%llu\n", (unsigned long long)((const Node*)item)->priority);
+}
+
+/**
+ * next_random()
+ *      xorshift generator so every variant sees the same priorities
+ * args -
+ *      state - generator state, updated
+ * returns -
+ *      the next random number
+ */
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * bench_heap()
+ *      times HeapADT with a malloc'd node per item against PQueue.
+ *      The "bulk" pattern pushes every item then pops them all,
+ *      the "search" pattern pushes up to three items per pop 
+ *      the way the maze solver expands a cell.
+ * args -
+ *      items - the amount of items to push
+ */
+static void bench_heap(size_t items) {
+    uint64_t seed, checksum = 0;
+    double start;
+
+    seed = 88172645463325252ull;
+    start = now();
+    Heap heap = createHeap(64, cmpNodes, dumpNode);
+    for(size_t i = 0; i < items; i++) {
+        Node* node = malloc(sizeof(Node));
+        node->priority = next_random(&seed) % items;
+        node->item = i;
+        insertHeapItem(heap, node);
+    }
+    while(sizeHeap(heap)) {
+        Node* node = removeTopHeap(heap);
+        checksum += node->item;
+        free(node);
+    }
+    destroyHeap(heap);
+    report("heap", "HeapADT-bulk", "random", items, now() - start, 2.0 * items, NULL, NULL);
+
+    seed = 88172645463325252ull;
+    start = now();
+    PQueue pq = pq_create(64);
+    for(size_t i = 0; i < items; i++)
+        pq_push(pq, next_random(&seed) % items, i);
+    while(!pq_empty(pq))
+        checksum -= pq_pop(pq, NULL);
+    pq_destroy(pq);
+    report("heap", "PQueue-bulk", "random", items, now() - start, 2.0 * items, NULL, NULL);
+
+    seed = 88172645463325252ull;
+    start = now();
+    heap = createHeap(64, cmpNodes, dumpNode);
+    size_t pushed = 0;
+    while(pushed < items) {
+        for(uint64_t n = next_random(&seed) % 4; n && pushed < items; n--) {
+            Node* node = malloc(sizeof(Node));
+            node->priority = next_random(&seed) % items;
+            node->item = pushed++;
+            insertHeapItem(heap, node);
+        }
+        if(sizeHeap(heap)) free(removeTopHeap(heap));
+    }
+    while(sizeHeap(heap)) free(removeTopHeap(heap));
+    destroyHeap(heap);
+    report("heap", "HeapADT-search", "random", items, now() - start, 2.0 * items, NULL, NULL);
+
+    seed = 88172645463325252ull;
+    start = now();
+    pq = pq_create(64);
+    pushed = 0;
+    while(pushed < items) {
+        for(uint64_t n = next_random(&seed) % 4; n && pushed < items; n--)
+            pq_push(pq, next_random(&seed) % items, pushed++);
+        if(!pq_empty(pq)) pq_pop(pq, NULL);
+    }
+    while(!pq_empty(pq)) pq_pop(pq, NULL);
+    pq_destroy(pq);
+    report("heap", "PQueue-search", "random", items, now() - start, 2.0 * items, NULL, NULL);
+
+    if(checksum != 0) fprintf(stderr, "heap: queues disagree\n");
+}
+
+/**
+ * bench_adts()
+ *      times the queue and stack the solvers were built on, each
+ *      is filled with every item and then emptied
+ * args -
+ *      items - the amount of items to push
+ */
+static void bench_adts(size_t items) {
+    size_t checksum = 0;
+    double start = now();
+    Queue queue = queue_create();
+    for(size_t i = 0; i < items; i++) queue_enqueue(queue, (void*)(i + 1));
+    while(!queue_empty(queue)) checksum += (size_t)queue_dequeue(queue);
+    queue_destroy(queue);
+    report("adt", "queueADT", "sequence", items, now() - start, 
+            2.0 * items, NULL, NULL);
+
+    start = now();
+    StackADT stack = stk_create();
+    for(size_t i = 0; i < items; i++) stk_push(stack, (void*)(i + 1));
+    while(!stk_empty(stack)) checksum -= (size_t)stk_pop(stack);
+    stk_destroy(stack);
+    report("adt", "stackADT", "sequence", items, now() - start, 
+            2.0 * items, NULL, NULL);
+
+    if(checksum != 0) fprintf(stderr, "adt: queue and stack disagree\n");
+}
+
+/**
+ * family_maze()
+ *      builds a maze of a family named by a benchmark
+ *
+ *      "open" mazes are GEN_RANDOM mazes with OPEN_DENSITY percent of
+ *      the cells walled, every other name is a family of mazegen.h.
+ *      The seed is always GEN_SEED so every run times the same mazes
+ * args -
+ *      family - the name of the family
+ *      width - cells per row
+ *      height - the amount of rows
+ * returns -
+ *      the maze, or NULL if the family is unknown or a terrain maze
+ *      would be too large
+ */
+static Maze family_maze(const char* family, int width, int height) {
+    MazeFamily kind = GEN_RANDOM;
+    if(strcmp(family, "open") && !maze_family(family, &kind)) return NULL;
+    if(kind == GEN_TERRAIN && (size_t)width * height > MAX_WEIGHTED_CELLS) {
+        fprintf(stderr, "%s: at most %zu cells\n", family, MAX_WEIGHTED_CELLS);
+        return NULL;
+    }
+    return generate_maze(kind, width, height, OPEN_DENSITY, GEN_SEED);
+}
+
+/**
+ * bench_solvers()
+ *      times every solver on one maze
+ * args -
+ *      maze - the maze to solve
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ */
+static void bench_solvers(Maze maze, const char* input, size_t cells) {
+    for(size_t s = 0; s < SOLVER_COUNT; s++) {
+        SolveStats stats;
+        double start = now();
+        int steps = solve_maze_with(maze, SOLVERS[s].solver, &stats);
+        double seconds = now() - start;
+        report("solve", SOLVERS[s].name, input, cells, seconds, 
+                (double)cells, &stats, NULL);
+        if(steps < 0) fprintf(stderr, "%s: no solution\n", input);
+    }
+}
+
+/**
+ * bench_scaling()
+ *      times the threaded solver with 1 to threads threads,
+ *      checking each path is as long as the serial solver's
+ * args -
+ *      maze - the maze to solve
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ *      threads - the most threads to try
+ */
+static void bench_scaling(Maze maze, const char* input, size_t cells, 
+                int threads) {
+    int serial = solve_maze_with(maze, SOLVE_BITBFS, NULL);
+    for(int t = 1; t <= threads; t++) {
+        SolveStats stats;
+        char variant[32];
+        snprintf(variant, sizeof(variant), "parbfs-%d", t);
+        double start = now();
+        int steps = solve_maze_parallel(maze, t, &stats);
+        double seconds = now() - start;
+        report("scaling", variant, input, cells, seconds, 
+                (double)cells, &stats, NULL);
+        if(steps != serial) 
+            fprintf(stderr, "%s: %d threads found %d steps, expected %d\n",
+                    input, t, steps, serial);
+    }
+}
+
+/// one thread of bench_shared()
+typedef struct {
+    Maze maze; /// the maze every thread solves
+    size_t rounds; /// the amount of solves
+    int steps; /// the steps of the last solve
+    SolveStats stats; /// the counters of the last solve
+} Solves;
+
+/**
+ * shared_solves()
+ *      solves one maze again and again in a workspace of its own,
+ *      the thread body of bench_shared()
+ * args -
+ *      arg - the Solves of the thread
+ * returns -
+ *      NULL
+ */
+static void* shared_solves(void* arg) {
+    Solves* solves = arg;
+    Workspace work = workspace_create();
+    for(size_t r = 0; r < solves->rounds; r++)
+        solves->steps = solve_maze_in(solves->maze, work, SOLVE_BITBFS, 
+                            &solves->stats);
+    workspace_destroy(work);
+    return NULL;
+}
+
+/**
+ * bench_shared()
+ *      times 1 to threads threads solving one maze at once, each in
+ *      its own workspace reused for every round, checking each path
+ *      is as long as the one found solving the maze itself
+ * args -
+ *      maze - the maze to solve
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ *      threads - the most threads to try
+ *      rounds - the amount of solves each thread runs
+ */
+static void bench_shared(Maze maze, const char* input, size_t cells, 
+                int threads, size_t rounds) {
+    int serial = solve_maze_with(maze, SOLVE_BITBFS, NULL);
+    pthread_t* ids = malloc(sizeof(pthread_t) * threads);
+    Solves* solves = malloc(sizeof(Solves) * threads);
+    if(ids == NULL || solves == NULL) {
+        perror("malloc");
+        free(ids);
+        free(solves);
+        return;
+    }
+    for(int t = 1; t <= threads; t++) {
+        char variant[32];
+        snprintf(variant, sizeof(variant), "workspace-%d", t);
+        int started = 0;
+        double start = now();
+        for(; started < t; started++) {
+            solves[started] = (Solves){maze, rounds, 0, {0, 0}};
+            if(pthread_create(&ids[started], NULL, shared_solves, 
+                    &solves[started])) {
+                perror("pthread_create");
+                break;
+            }
+        }
+        for(int n = 0; n < started; n++)
+            pthread_join(ids[n], NULL);
+        double seconds = now() - start;
+        report("shared", variant, input, cells, seconds, 
+                (double)cells * rounds * started, &solves[0].stats, NULL);
+        for(int n = 0; n < started; n++)
+            if(solves[n].steps != serial)
+                fprintf(stderr, "%s: thread %d found %d steps, expected %d\n",
+                        input, n, solves[n].steps, serial);
+    }
+    free(ids);
+    free(solves);
+}
+
+/**
+ * bench_layout()
+ *      times the cell by cell solvers on the row major and the tiled
+ *      layout, with the cache and TLB misses of each solve when the
+ *      machine can count them
+ * args -
+ *      maze - the maze to solve, left row major
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ */
+static void bench_layout(Maze maze, const char* input, size_t cells) {
+    const char* layouts[] = {"rows", "tiles"};
+    for(int l = 0; l < 2; l++) {
+        set_maze_layout(maze, (l)?MAZE_TILES:MAZE_ROWS);
+        // the first solve sizes the search arena for the layout
+        solve_maze_with(maze, SOLVE_BIBFS, NULL);
+        for(size_t s = 0; s < CELL_SOLVER_COUNT; s++) {
+            SolveStats stats;
+            Misses misses;
+            Probe probe;
+            char variant[32];
+            snprintf(variant, sizeof(variant), "%s-%s", 
+                    CELL_SOLVERS[s].name, layouts[l]);
+            probe_start(&probe);
+            double start = now();
+            int steps = solve_maze_with(maze, CELL_SOLVERS[s].solver, &stats);
+            double seconds = now() - start;
+            probe_stop(&probe, &misses);
+            report("layout", variant, input, cells, seconds, 
+                    (double)cells, &stats, &misses);
+            if(steps < 0) fprintf(stderr, "%s: no solution\n", input);
+        }
+    }
+    set_maze_layout(maze, MAZE_ROWS);
+}
+
+/**
+ * bench_hpa()
+ *      times building a hierarchical index and answering queries 
+ *      between random open cells with it, then compares the corner 
+ *      to corner query with the shortest path
+ * args -
+ *      maze - the maze to index
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ *      queries - the amount of random queries
+ */
+static void bench_hpa(Maze maze, const char* input, size_t cells, 
+                size_t queries) {
+    int width = maze_width(maze), height = maze_height(maze);
+    double start = now();
+    PathIndex index = hpa_build(maze, 0);
+    report("hpa", "build", input, cells, now() - start, (double)cells, 
+            NULL, NULL);
+
+    // the same cells are asked for on every run
+    uint64_t seed = 88172645463325252ull;
+    SolveStats total = {0, 0};
+    start = now();
+    for(size_t q = 0; q < queries; q++) {
+        SolveStats stats;
+        hpa_solve(index, maze, next_random(&seed) % height, 
+                next_random(&seed) % width, next_random(&seed) % height,
+                next_random(&seed) % width, &stats);
+        total.expanded += stats.expanded;
+        total.pushed += stats.pushed;
+    }
+    report("hpa", "query", input, queries, now() - start, (double)queries, 
+            &total, NULL);
+
+    SolveStats stats;
+    start = now();
+    int steps = hpa_solve(index, maze, 0, 0, height - 1, width - 1, &stats);
+    report("hpa", "corner", input, cells, now() - start, (double)cells, 
+            &stats, NULL);
+    int shortest = solve_maze_with(maze, SOLVE_BIBFS, NULL);
+    if(steps != shortest)
+        fprintf(stderr, "%s: hpa path %d steps, shortest %d\n", 
+                input, steps, shortest);
+    hpa_destroy(index);
+}
+
+/**
+ * bench_field()
+ *      times making a distance field to the exit and answering random
+ *      starts with it, first only the distance then the whole path
+ * args -
+ *      maze - the maze
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ *      queries - the amount of random starts
+ */
+static void bench_field(Maze maze, const char* input, size_t cells, 
+                size_t queries) {
+    int width = maze_width(maze), height = maze_height(maze);
+    SolveStats stats;
+    double start = now();
+    DistanceField field = field_create(maze, height - 1, width - 1, &stats);
+    report("field", "create", input, cells, now() - start, (double)cells, 
+            &stats, NULL);
+    if(field == NULL) return;
+
+    // the same cells are asked for by both variants
+    uint64_t seed = 88172645463325252ull;
+    size_t reached = 0;
+    start = now();
+    for(size_t q = 0; q < queries; q++)
+        reached += field_distance(field, next_random(&seed) % height, 
+                        next_random(&seed) % width) > 0;
+    report("field", "distance", input, queries, now() - start, 
+            (double)queries, NULL, NULL);
+
+    MazeCell* path = malloc(sizeof(MazeCell) * cells);
+    if(path == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    seed = 88172645463325252ull;
+    start = now();
+    for(size_t q = 0; q < queries; q++)
+        field_path(field, next_random(&seed) % height, 
+                next_random(&seed) % width, path, cells);
+    report("field", "path", input, queries, now() - start, 
+            (double)queries, NULL, NULL);
+    if(!reached) fprintf(stderr, "%s: no start reached the exit\n", input);
+    free(path);
+    field_destroy(field);
+}
+
+/**
+ * bench_plan()
+ *      times repairing an incremental search after batches of random
+ *      cells are toggled, against solving the edited maze from scratch
+ * args -
+ *      maze - the maze, its cells are changed
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ *      rounds - the amount of batches of each size
+ */
+static void bench_plan(Maze maze, const char* input, size_t cells, 
+                size_t rounds) {
+    int width = maze_width(maze), height = maze_height(maze);
+    Planner plan = plan_create(maze, 0, 0, height - 1, width - 1);
+    SolveStats stats;
+    double start = now();
+    plan_solve(plan, &stats);
+    report("plan", "initial", input, cells, now() - start, (double)cells, 
+            &stats, NULL);
+
+    uint64_t seed = 88172645463325252ull;
+    const size_t batches[] = {1, 10, 100};
+    for(int b = 0; b < 3; b++) {
+        SolveStats repaired = {0, 0}, solved = {0, 0};
+        double planning = 0, solving = 0;
+        for(size_t r = 0; r < rounds; r++) {
+            for(size_t e = 0; e < batches[b]; e++) {
+                int row = next_random(&seed) % height;
+                int column = next_random(&seed) % width;
+                // the corners stay open so there is something to find
+                if((!row && !column) || 
+                        (row == height - 1 && column == width - 1))
+                    continue;
+                plan_toggle(plan, row, column);
+            }
+            start = now();
+            int steps = plan_solve(plan, &stats);
+            planning += now() - start;
+            repaired.expanded += stats.expanded;
+            repaired.pushed += stats.pushed;
+
+            start = now();
+            int shortest = solve_maze_with(maze, SOLVE_BIBFS, &stats);
+            solving += now() - start;
+            solved.expanded += stats.expanded;
+            solved.pushed += stats.pushed;
+            if(steps != shortest)
+                fprintf(stderr, "%s: plan path %d steps, shortest %d\n", 
+                        input, steps, shortest);
+        }
+        char variant[32];
+        sprintf(variant, "update_%zu", batches[b]);
+        report("plan", variant, input, batches[b], planning, (double)rounds,
+                &repaired, NULL);
+        sprintf(variant, "bibfs_%zu", batches[b]);
+        report("plan", variant, input, batches[b], solving, (double)rounds,
+                &solved, NULL);
+    }
+    plan_destroy(plan);
+}
+
+/**
+ * bench_label()
+ *      times labeling the regions of a maze, then solving it
+ *      before and after it is labeled
+ * args -
+ *      maze - the maze
+ *      input - the name of the maze for the report
+ *      cells - the amount of cells in the maze
+ */
+static void bench_label(Maze maze, const char* input, size_t cells) {
+    SolveStats stats;
+    double start = now();
+    int steps = solve_maze_with(maze, SOLVE_BITBFS, &stats);
+    report("label", "unlabeled", input, cells, now() - start, 
+            (double)cells, &stats, NULL);
+
+    start = now();
+    size_t regions = label_maze(maze);
+    report("label", "label", input, cells, now() - start, (double)cells, 
+            NULL, NULL);
+
+    start = now();
+    int labeled = solve_maze_with(maze, SOLVE_BITBFS, &stats);
+    report("label", "labeled", input, cells, now() - start, 
+            (double)cells, &stats, NULL);
+    if(steps != labeled)
+        fprintf(stderr, "%s: labeled solve %d steps, unlabeled %d\n", 
+                input, labeled, steps);
+    if(!regions) fprintf(stderr, "%s: no open cells\n", input);
+}
+
+/**
+ * bench_band()
+ *      times solving a maze file in memory against solving it in bands
+ *      under a memory limit, and counts the bands read. A corridor
+ *      crossing every band once reads each band about once, a corridor
+ *      winding down and up the columns reads them once per column
+ * args -
+ *      family - the name of the family
+ *      width - cells per row
+ *      height - the amount of rows
+ *      limit - the memory limit of the bands
+ * returns -
+ *      0 if both solves ran, 1 otherwise
+ */
+static int bench_band(const char* family, int width, int height, 
+                size_t limit) {
+    size_t cells = (size_t)width * height;
+    Maze maze = family_maze(family, width, height);
+    FILE* text = tmpfile();
+    if(maze == NULL || text == NULL) {
+        if(text == NULL) perror("tmpfile");
+        if(maze != NULL) clean_maze(maze);
+        return 1;
+    }
+    save_maze(maze, text, MAZE_TEXT);
+    fflush(text);
+    clean_maze(maze);
+
+    SolveStats stats;
+    rewind(text);
+    double start = now();
+    maze = create_maze(text);
+    int steps = (maze != NULL)?solve_maze_with(maze, SOLVE_BITBFS, &stats):-1;
+    report("band", "in-memory", family, cells, now() - start, 
+            (double)cells, &stats, NULL);
+    if(maze != NULL) clean_maze(maze);
+
+    start = now();
+    BandMaze bands = band_open(text, limit);
+    int banded = (bands != NULL)?band_solve(bands, &stats):BAND_FAILED;
+    double seconds = now() - start;
+    report("band", "bands", family, cells, seconds, (double)cells, 
+            &stats, NULL);
+    if(bands != NULL) {
+        // size is the amount of bands read, rate bands read per second
+        report("band", "reads", family, band_reads(bands), seconds, 
+                (double)band_reads(bands), NULL, NULL);
+        band_close(bands);
+    }
+    fclose(text);
+    if(banded != steps)
+        fprintf(stderr, "%s: bands solve %d steps, in memory %d\n",
+                family, banded, steps);
+    return banded == BAND_FAILED || banded != steps;
+}
+
+/**
+ * bench_case()
+ *      times one generated maze through the stages of mopsolver
+ *      separately: parsing its text, solving it, and printing it
+ * args -
+ *      family - the name of the family
+ *      size - cells along each side of the maze
+ * returns -
+ *      0 if the stages ran, 1 otherwise
+ */
+static int bench_case(const char* family, int size) {
+    size_t cells = (size_t)size * size;
+    double start = now();
+    Maze maze = family_maze(family, size, size);
+    if(maze == NULL) return 1;
+    report("generate", "generate_maze", family, cells, now() - start, 
+            (double)cells, NULL, NULL);
+
+    FILE* text = tmpfile();
+    if(text == NULL) {
+        perror("tmpfile");
+        clean_maze(maze);
+        return 1;
+    }
+    save_maze(maze, text, MAZE_TEXT);
+    clean_maze(maze);
+    rewind(text);
+    start = now();
+    maze = create_maze(text);
+    report("parse", "create_maze", family, cells, now() - start, 
+            (double)cells, NULL, NULL);
+    fclose(text);
+    if(maze == NULL) return 1;
+
+    start = now();
+    int steps = solve_maze(maze);
+    report("solve", "solve_maze", family, cells, now() - start, 
+            (double)cells, NULL, NULL);
+    if(steps < 0 && strcmp(family, "sealed"))
+        fprintf(stderr, "%s: no solution\n", family);
+    if(steps >= 0 && !strcmp(family, "sealed"))
+        fprintf(stderr, "%s: solved a sealed maze\n", family);
+
+    FILE* sink = fopen("/dev/null", "w");
+    if(sink == NULL) {
+        perror("/dev/null");
+        clean_maze(maze);
+        return 1;
+    }
+    start = now();
+    pretty_print_maze(maze, sink);
+    fflush(sink);
+    report("print", "pretty_print_maze", family, cells, now() - start, 
+            (double)cells, NULL, NULL);
+    fclose(sink);
+    clean_maze(maze);
+    return 0;
+}
+
+/**
+ * bench_suite()
+ *      runs every family through bench_case() at each size. Each case
+ *      runs in a child process so its peak_rss_kb is its own and not
+ *      the largest maze seen so far
+ * args -
+ *      sizes - the sizes of the mazes, as text
+ *      count - the amount of sizes
+ * returns -
+ *      the amount of cases that failed
+ */
+static int bench_suite(char** sizes, int count) {
+    const char* families[] = {"perfect", "rooms", "random", "sealed"};
+    int failed = 0;
+    fflush(stdout);
+    for(int s = 0; s < count; s++) {
+        for(int f = 0; f < 4; f++) {
+            pid_t child = fork();
+            if(child < 0) {
+                perror("fork");
+                return failed + 1;
+            } else if(!child) {
+                int result = bench_case(families[f], atoi(sizes[s]));
+                fflush(stdout);
+                _exit(result);
+            }
+            int status;
+            if(waitpid(child, &status, 0) < 0 || !WIFEXITED(status) ||
+                    WEXITSTATUS(status)) {
+                fprintf(stderr, "suite: %s %s failed\n", families[f], 
+                        sizes[s]);
+                failed++;
+            }
+        }
+    }
+    bench_adts(SUITE_ITEMS);
+    return failed;
+}
+
+/**
+ * usage_message()
+ *      prints the usage message for the program
+ * args -
+ *      stream - location to print the usage information
+ */
+static void usage_message(FILE* stream) {
+    fprintf(stream, "USAGE:\nmopbench heap [ITEMS]\n"
+                    "mopbench solvers [SIZE]\n"
+                    "mopbench scaling [SIZE] [THREADS]\n"
+                    "mopbench shared [SIZE] [THREADS] [ROUNDS]\n"
+                    "mopbench layout [WIDTH] [HEIGHT]\n"
+                    "mopbench hpa [SIZE] [QUERIES]\n"
+                    "mopbench field [SIZE] [QUERIES]\n"
+                    "mopbench plan [SIZE] [ROUNDS]\n"
+                    "mopbench label [SIZE]\n"
+                    "mopbench band [WIDTH] [HEIGHT] [LIMIT]\n"
+                    "mopbench suite [SIZE...]\n"
+                    "mopbench solve MAZEFILE...\n");
+}
+
+/**
+ * main()
+ *      runs the requested benchmark
+ * args - 
+ *      argc -   the amount of arguments passed into this program
+ *      argv -   the arguments passed into this program as a string array
+ */
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        usage_message(stderr);
+        return EXIT_FAILURE;
+    }
+    printf("benchmark,variant,input,size,seconds,rate,expanded,pushed,"
+            "cache_misses,tlb_misses,peak_rss_kb\n");
+    if(!strcmp(argv[1], "heap")) {
+        bench_heap((argc > 2)?strtoul(argv[2], NULL, 10):HEAP_ITEMS);
+    } else if(!strcmp(argv[1], "solvers")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        // every solver runs as dial on the weighted terrain
+        const char* families[] = {"open", "corridor", "terrain"};
+        for(int f = 0; f < 3; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_solvers(maze, families[f], (size_t)size * size);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "scaling")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        int threads = (argc > 3)?atoi(argv[3]):
+                        (int)sysconf(_SC_NPROCESSORS_ONLN);
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_scaling(maze, families[f], (size_t)size * size, threads);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "shared")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        int threads = (argc > 3)?atoi(argv[3]):
+                        (int)sysconf(_SC_NPROCESSORS_ONLN);
+        size_t rounds = (argc > 4)?strtoul(argv[4], NULL, 10):SHARED_ROUNDS;
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_shared(maze, families[f], (size_t)size * size, threads, 
+                    rounds);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "layout")) {
+        int width = (argc > 2)?atoi(argv[2]):WIDE_WIDTH;
+        int height = (argc > 3)?atoi(argv[3]):WIDE_HEIGHT;
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], width, height);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_layout(maze, families[f], (size_t)width * height);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "hpa")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        size_t queries = (argc > 3)?strtoul(argv[3], NULL, 10):HPA_QUERIES;
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_hpa(maze, families[f], (size_t)size * size, queries);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "field")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        size_t queries = (argc > 3)?strtoul(argv[3], NULL, 10):FIELD_QUERIES;
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_field(maze, families[f], (size_t)size * size, queries);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "plan")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        size_t rounds = (argc > 3)?strtoul(argv[3], NULL, 10):PLAN_ROUNDS;
+        const char* families[] = {"open", "corridor"};
+        for(int f = 0; f < 2; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_plan(maze, families[f], (size_t)size * size, rounds);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "label")) {
+        int size = (argc > 2)?atoi(argv[2]):MAZE_SIZE;
+        const char* families[] = {"open", "corridor", "sealed"};
+        for(int f = 0; f < 3; f++) {
+            Maze maze = family_maze(families[f], size, size);
+            if(maze == NULL) return EXIT_FAILURE;
+            bench_label(maze, families[f], (size_t)size * size);
+            clean_maze(maze);
+        }
+    } else if(!strcmp(argv[1], "band")) {
+        int width = (argc > 2)?atoi(argv[2]):BAND_WIDTH;
+        int height = (argc > 3)?atoi(argv[3]):BAND_HEIGHT;
+        size_t limit = (argc > 4)?strtoul(argv[4], NULL, 10):BAND_LIMIT;
+        const char* families[] = {"corridor", "columns"};
+        for(int f = 0; f < 2; f++)
+            if(bench_band(families[f], width, height, limit)) 
+                return EXIT_FAILURE;
+    } else if(!strcmp(argv[1], "suite")) {
+        char* sizes[] = {"10", "100", "1000"};
+        if(argc > 2) {
+            if(bench_suite(argv + 2, argc - 2)) return EXIT_FAILURE;
+        } else if(bench_suite(sizes, 3)) {
+            return EXIT_FAILURE;
+        }
+    } else if(!strcmp(argv[1], "solve")) {
+        for(int a = 2; a < argc; a++) {
+            FILE* input = fopen(argv[a], "r");
+            if(input == NULL) {
+                perror(argv[a]);
+                return EXIT_FAILURE;
+            }
+            double start = now();
+            Maze maze = create_maze(input);
+            double seconds = now() - start;
+            fclose(input);
+            if(maze == NULL) return EXIT_FAILURE;
+            size_t cells = maze_width(maze) * (size_t)maze_height(maze);
+            report("parse", "create_maze", argv[a], cells, seconds, 
+                    (double)cells, NULL, NULL);
+            bench_solvers(maze, argv[a], cells);
+            clean_maze(maze);
+        }
+    } else {
+        usage_message(stderr);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
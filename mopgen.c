@@ -0,0 +1,138 @@
+/// file: mopgen.c
+/// description: generates mazes for mopsolver and mopbench
+/// author: Nicholas R. Chieppa
+///
+
+#define _DEFAULT_SOURCE
+
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "maze.h"
+#include "mazegen.h"
+
+#define VALID_FLAGS "hf:d:r:w:o:" /// flags respected by this program
+
+#define FAMILY GEN_PERFECT /// default value for -f
+#define DENSITY 30 /// default value for -d
+#define SEED GEN_SEED /// default value for -r
+#define OUTPUT_STREAM stdout /// default value for -o
+
+/**
+ * usage_message()
+ *      prints the usage message for the program
+ * args -
+ *      stream - location to print the usage information
+ */
+void usage_message(FILE* stream) {
+    fprintf(stream, "USAGE:\nmopgen [-h] [-f FAMILY] [-d DENSITY] [-r SEED] "
+                    "[-w FORMAT] [-o OUTFILE] WIDTH HEIGHT\n");
+}
+
+/**
+ * help_message()
+ *      prints the help message for flag -h
+ */
+void help_message() {
+    printf("Options:\n");
+    printf("\t-h\tPrint this helpful message to stdout and exit.\n");
+    printf("\t-f FAMILY\tGenerate a perfect, rooms, random, sealed,\n"
+                "\t\tcorridor, terrain or columns maze, see mazegen.h.\n"
+                "\t\t\t\t\t\t\t(Default: perfect)\n");
+    printf("\t-d DENSITY\tPercent of cells walled in random, sealed and\n"
+                "\t\tterrain mazes.\t\t\t\t\t(Default: 30)\n");
+    printf("\t-r SEED\tSeed of the random choices, the same seed always\n"
+                "\t\tgives the same maze.\t\t\t(Default: %llu)\n", GEN_SEED);
+    printf("\t-w FORMAT\tWrite the maze as text or binary."
+                "\t(Default: text)\n");
+    printf("\t-o OUTFILE\tWrite the maze to OUTFILE."
+                "\t\t(Default: stdout)\n");
+}
+
+/**
+ * main()
+ *      runs the maze generator application
+ * args -
+ *      argc -   the amount of arguments passed into this program
+ *      argv -   the arguments passed into this program as a string array
+ */
+int main(int argc, char** argv) {
+    MazeFamily f = FAMILY;
+    long d = DENSITY;
+    unsigned long long r = SEED;
+    MazeFormat format = MAZE_TEXT;
+    char *outputloc = NULL;
+    FILE *o = OUTPUT_STREAM;
+
+    int c;
+    while((c = getopt(argc, argv, VALID_FLAGS)) != -1) {
+        switch(c) {
+            case 'h':
+                usage_message(stdout);
+                help_message();
+                return EXIT_SUCCESS;
+            case 'f':
+                if(!maze_family(optarg, &f)) {
+                    fprintf(stderr, "unknown family: %s\n", optarg);
+                    usage_message(stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                d = strtol(optarg, NULL, 10);
+                if(d < 0 || d > 100) {
+                    usage_message(stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                r = strtoull(optarg, NULL, 10);
+                break;
+            case 'w':
+                if(!strcmp(optarg, "binary"))
+                    format = MAZE_BINARY;
+                else if(strcmp(optarg, "text")) {
+                    usage_message(stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o':
+                outputloc = optarg;
+                break;
+            case '?': // Argument not found
+                usage_message(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+    if(argc - optind != 2) {
+        usage_message(stderr);
+        return EXIT_FAILURE;
+    }
+    long width = strtol(argv[optind], NULL, 10);
+    long height = strtol(argv[optind + 1], NULL, 10);
+    if(width < 1 || height < 1 || width > INT_MAX || height > INT_MAX) {
+        usage_message(stderr);
+        return EXIT_FAILURE;
+    }
+    if(f == GEN_TERRAIN && (size_t)width * height > MAX_WEIGHTED_CELLS) {
+        fprintf(stderr, "mopgen: a terrain maze may have at most %zu cells\n",
+                    MAX_WEIGHTED_CELLS);
+        return EXIT_FAILURE;
+    }
+
+    if(outputloc != NULL && (o = fopen(outputloc, "w")) == NULL) {
+        perror(outputloc);
+        return EXIT_FAILURE;
+    }
+    Maze maze = generate_maze(f, (int)width, (int)height, (int)d, r);
+    int exit = EXIT_SUCCESS;
+    if(save_maze(maze, o, format) || fflush(o)) {
+        perror("write");
+        exit = EXIT_FAILURE;
+    }
+    clean_maze(maze);
+    if(o != stdout) fclose(o);
+    return exit;
+}
@@ -9,14 +9,37 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
 #include "maze.h"
+#include "mazeband.h"
+#include "mazebatch.h"
+#include "mazecache.h"
+#include "mazehpa.h"
+#include "mazeserver.h"
+#include "mazestats.h"
 
-#define VALID_FLAGS "hdspi:o:" /// flags respected by this program
-#define ARG_COUNT 6 /// amount of flags respected by this program
+#define VALID_FLAGS "hdsptlevm:j:b:S:c:H:f:g:w:M:i:o:" /// flags respected by this program
+#define ARG_COUNT 20 /// amount of flags respected by this program
 
 #define PRETTY_PRINT 0 /// default value for -d
 #define PRINT_STEP_COUNT 0 /// default value for -s
 #define PRINT_OPTIMAL 0 /// default value for -p
+#define PRINT_EXPANDED 0 /// default value for -e
+#define PRINT_STATS 0 /// default value for -v
+#define TILED 0 /// default value for -t
+#define LABEL 0 /// default value for -l
+#define SOLVER SOLVE_BITBFS /// default value for -m
+#define THREADS 0 /// default value for -j, 0 solves without threads
+#define BATCH NULL /// default value for -b
+#define SOCKET NULL /// default value for -S
+#define CACHE NULL /// default value for -c
+#define CACHE_ENTRIES 4096 /// solutions kept by the -c cache
+#define INDEX NULL /// default value for -H
+#define GOAL 0 /// default value for -g, 0 ends paths at the bottom right
+#define CONVERT 0 /// default value for -w, 0 solves instead of converting
+#define MEMORY_LIMIT 0 /// default value for -M, 0 loads the whole maze
 #define INPUT_STREAM stdin /// default value for -i
 #define OUTPUT_STREAM stdout /// default value for -o
 
@@ -31,6 +54,219 @@ void protected_free(void* pointer) {
         free(pointer);
 }
 
+/**
+ * now()
+ *      reads a monotonic clock for timing the phases reported by -v
+ * returns -
+ *      the current time in seconds
+ */
+double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * parse_solver()
+ *      finds the search strategy named by -m
+ * args -
+ *      name - the name given on the command line
+ *      solver - location to store the strategy
+ * returns -
+ *      1 if the name is known, 0 otherwise
+ */
+int parse_solver(const char* name, Solver* solver) {
+    if(!strcmp(name, "greedy"))
+        *solver = SOLVE_GREEDY;
+    else if(!strcmp(name, "astar"))
+        *solver = SOLVE_ASTAR;
+    else if(!strcmp(name, "bibfs"))
+        *solver = SOLVE_BIBFS;
+    else if(!strcmp(name, "jps"))
+        *solver = SOLVE_JPS;
+    else if(!strcmp(name, "bitbfs"))
+        *solver = SOLVE_BITBFS;
+    else if(!strcmp(name, "parbfs"))
+        *solver = SOLVE_PARBFS;
+    else if(!strcmp(name, "dial"))
+        *solver = SOLVE_DIAL;
+    else
+        return 0;
+    return 1;
+}
+
+/**
+ * parse_format()
+ *      finds the file format named by -w
+ * args -
+ *      name - the name given on the command line
+ *      format - location to store the format
+ * returns -
+ *      1 if the name is known, 0 otherwise
+ */
+int parse_format(const char* name, MazeFormat* format) {
+    if(!strcmp(name, "text"))
+        *format = MAZE_TEXT;
+    else if(!strcmp(name, "binary"))
+        *format = MAZE_BINARY;
+    else
+        return 0;
+    return 1;
+}
+
+/**
+ * parse_cell()
+ *      reads a cell given as ROW,COLUMN for -f and -g
+ * args -
+ *      text - the text given on the command line
+ *      cell - location to store the cell
+ * returns -
+ *      1 if the text names a cell, 0 otherwise
+ */
+int parse_cell(const char* text, MazeCell* cell) {
+    char* end;
+    long row = strtol(text, &end, 10);
+    if(end == text || *end != ',') return 0;
+    text = end + 1;
+    long column = strtol(text, &end, 10);
+    if(end == text || *end || row < 0 || column < 0 || 
+            row > INT_MAX || column > INT_MAX) 
+        return 0;
+    cell->row = (int)row;
+    cell->column = (int)column;
+    return 1;
+}
+
+/**
+ * parse_limit()
+ *      reads a byte count given for -M, with an optional K, M or G suffix
+ * args -
+ *      text - the text given on the command line
+ *      limit - location to store the bytes
+ * returns -
+ *      1 if the text is a positive byte count, 0 otherwise
+ */
+int parse_limit(const char* text, size_t* limit) {
+    char* end;
+    unsigned long long bytes = strtoull(text, &end, 10);
+    int shift = 0;
+    if(end == text || *text == '-') return 0;
+    if(*end == 'K' || *end == 'k') shift = 10;
+    else if(*end == 'M' || *end == 'm') shift = 20;
+    else if(*end == 'G' || *end == 'g') shift = 30;
+    if(shift) end++;
+    if(*end || !bytes || bytes > (SIZE_MAX >> shift)) return 0;
+    *limit = (size_t)bytes << shift;
+    return 1;
+}
+
+/**
+ * solve_starts()
+ *      answers every start with one distance field from the goal,
+ *      marking the path from the last start in the maze
+ * args -
+ *      maze - the maze to solve
+ *      starts - the cells paths start at
+ *      count - the amount of starts
+ *      goal - the cell every path ends at
+ *      s - print the steps of every start
+ *      stats - location to store the counters of the field's search
+ *      output - where to print the steps
+ * returns -
+ *      the path distance from the last start, or -1 if there is none
+ */
+int solve_starts(Maze maze, const MazeCell* starts, size_t count, 
+                MazeCell goal, int s, SolveStats* stats, FILE* output) {
+    DistanceField field = field_create(maze, goal.row, goal.column, stats);
+    if(field == NULL) { // a walled goal is reached from nowhere
+        stats->expanded = stats->pushed = 0;
+        for(size_t n = 0; s && n < count; n++)
+            fprintf(output, "No solution.\n");
+        return -1;
+    }
+    int steps = -1;
+    for(size_t n = 0; n < count; n++) {
+        steps = (n + 1 < count)?
+            field_distance(field, starts[n].row, starts[n].column):
+            field_solve(field, maze, starts[n].row, starts[n].column);
+        if(s && steps > 0)
+            fprintf(output, "Solution in %i steps.\n", steps);
+        else if(s)
+            fprintf(output, "No solution.\n");
+    }
+    field_destroy(field);
+    return steps;
+}
+
+/**
+ * print_stats()
+ *      writes the report of -v as one line of JSON
+ * args -
+ *      output - where to write the report
+ *      width - the width of the maze that was solved
+ *      height - the height of the maze that was solved
+ *      steps - the result of the solve, 0 if it was not solved
+ *      stats - the counters of the solve
+ *      phases - seconds spent parsing, solving and printing
+ */
+void print_stats(FILE* output, int width, int height, int steps, 
+                const SolveStats* stats, const double* phases) {
+    fprintf(output, "{\"width\": %d, \"height\": %d, \"steps\": %d, "
+                    "\"expanded\": %lu, \"pushed\": %lu, ",
+                    width, height, steps, 
+                    stats->expanded, stats->pushed);
+    fprintf(output, "\"seconds\": {\"parse\": %.9f, \"solve\": %.9f, "
+                    "\"print\": %.9f}, \"counters\": ", 
+                    phases[0], phases[1], phases[2]);
+    stats_write(output);
+    fprintf(output, "}\n");
+}
+
+/**
+ * solve_bands()
+ *      solves a maze file a band of rows at a time for -M,
+ *      printing as main() does for the same flags
+ * args -
+ *      input - the maze file
+ *      limit - the bytes the bands may hold in memory
+ *      d, s, p, e, v - the flags of main()
+ *      output - where to print
+ * returns -
+ *      0 on success, -1 if the maze could not be read or solved
+ */
+int solve_bands(FILE* input, size_t limit, int d, int s, int p, int e, 
+                int v, FILE* output) {
+    double phases[3] = {0, 0, 0}, start = now();
+    stats_reset();
+    BandMaze maze = band_open(input, limit);
+    phases[0] = now() - start;
+    if(maze == NULL) return -1; // the reason was already reported
+    int steps = 0, failed = 0;
+    SolveStats stats = {0, 0};
+    start = now();
+    if(d) failed = band_print(maze, output);
+    phases[2] = now() - start;
+    start = now();
+    if(!failed && (s || p || e || v))
+        failed = ((steps = band_solve(maze, &stats)) == BAND_FAILED);
+    phases[1] = now() - start;
+    if(!failed && s && steps > 0)
+        fprintf(output, "Solution in %i steps.\n", steps);
+    else if(!failed && s)
+        fprintf(output, "No solution.\n");
+    if(!failed && e)
+        fprintf(output, "Expanded %lu cells, queued %lu.\n", 
+                stats.expanded, stats.pushed);
+    start = now();
+    if(!failed && p) failed = band_print(maze, output);
+    phases[2] += now() - start;
+    if(!failed && v)
+        print_stats(stderr, band_width(maze), band_height(maze), steps, 
+                    &stats, phases);
+    band_close(maze);
+    return (failed)?-1:0;
+}
+
 /**
  * usage_message()
  *      prints the usage message for the program
@@ -38,7 +274,15 @@ void protected_free(void* pointer) {
  *      stream - location to print the usage information
  */
 void usage_message(FILE* stream) {
-    fprintf(stream, "USAGE:\nmopsolver [-hdsp] [-i INFILE] [-o OUTFILE]\n");
+    fprintf(stream, "USAGE:\nmopsolver [-hdsptlev] [-m MODE] [-j THREADS] "
+                    "[-i INFILE] [-o OUTFILE]\n"
+                    "mopsolver -H INDEXFILE [-dsptle] [-i INFILE] [-o OUTFILE]\n"
+                    "mopsolver [-f ROW,COLUMN]... [-g ROW,COLUMN] [-dsptle] "
+                    "[-i INFILE] [-o OUTFILE]\n"
+                    "mopsolver -b DIR|- [-m MODE] [-j THREADS] [-o OUTFILE]\n"
+                    "mopsolver -S SOCKET [-m MODE] [-j THREADS]\n"
+                    "mopsolver -M LIMIT [-dspev] -i INFILE [-o OUTFILE]\n"
+                    "mopsolver -w FORMAT [-i INFILE] [-o OUTFILE]\n");
 }
 
 /**
@@ -52,6 +296,46 @@ void help_message() {
                 "after reading.\t(Default: off)\n");
     printf("\t-s\tPrint shorest solution steps."
                 "\t\t\t(Default: off)\n");
+    printf("\t-t\tStore the maze in 64x64 cell tiles, faster on very\n"
+                "\t\twide mazes, jps and bitbfs solve as bibfs.\t(Default: off)\n");
+    printf("\t-l\tLabel the connected regions of the maze after\n"
+                "\t\treading, a maze with no solution is answered\n"
+                "\t\twithout searching.\t\t\t\t(Default: off)\n");
+    printf("\t-e\tPrint the cells expanded by the solver."
+                "\t\t(Default: off)\n");
+    printf("\t-v\tPrint the counters and the seconds spent parsing,\n"
+                "\t\tsolving and printing as JSON to stderr. Counters\n"
+                "\t\tare null unless built with -DMAZE_STATS.\t(Default: off)\n");
+    printf("\t-m MODE\tSolve with MODE: greedy, astar, bibfs, jps,\n"
+                "\t\tbitbfs, parbfs or dial. Mazes with weighted cells\n"
+                "\t\tare always solved by cost with dial, -H, -f and\n"
+                "\t\t-g count each cell as one step.\t\t(Default: bitbfs)\n");
+    printf("\t-j THREADS\tSolve with a breadth first search split\n"
+                "\t\tacross THREADS threads, overrides -m.\t\t(Default: off)\n"
+                "\t\tWith -b or -S, the amount of mazes solved at once.\n"
+                "\t\t\t\t\t\t\t(Default: one per processor)\n");
+    printf("\t-b DIR\tSolve every file in DIR, or every path read from\n"
+                "\t\tstdin when DIR is -, printing a CSV row per maze.\n"
+                "\t\t\t\t\t\t\t(Default: off)\n");
+    printf("\t-c CACHEFILE\tReuse solutions saved in CACHEFILE and save\n"
+                "\t\tnew ones to it.\t\t\t\t\t(Default: off)\n");
+    printf("\t-H INDEXFILE\tSolve with the hierarchical index in INDEXFILE,\n"
+                "\t\tbuilt and saved when missing or stale. Paths are\n"
+                "\t\tclose to the shortest, overrides -m.\t\t(Default: off)\n");
+    printf("\t-f ROW,COLUMN\tStart a path at ROW,COLUMN, counted from 0. May\n"
+                "\t\tbe given many times, every start is answered from\n"
+                "\t\tone search from the goal and -p marks the last.\n"
+                "\t\tOverrides -m and -H.\t\t\t\t(Default: 0,0)\n");
+    printf("\t-g ROW,COLUMN\tEnd paths at ROW,COLUMN, overrides -m and -H.\n"
+                "\t\t\t\t\t\t(Default: the bottom right)\n");
+    printf("\t-S SOCKET\tServe solve requests on the unix socket SOCKET\n"
+                "\t\tuntil interrupted, see mazeserver.h.\t\t(Default: off)\n");
+    printf("\t-w FORMAT\tWrite the maze to the output as text or binary\n"
+                "\t\tand exit, INFILE may be either format.\t(Default: off)\n");
+    printf("\t-M LIMIT\tSolve INFILE a band of rows at a time, keeping\n"
+                "\t\tthe search in temporary files and under LIMIT\n"
+                "\t\tbytes of memory, K, M or G may follow LIMIT.\n"
+                "\t\tOverrides every other solving flag.\t(Default: off)\n");
     printf("\t-i INFILE\tRead maze from INFILE."
                 "\t\t\t(Default: stdin)\n");
     printf("\t-o OUTFILE\tWrite all output to OUTFILE."
@@ -68,6 +352,22 @@ void help_message() {
 int main(int argc, char** argv) {
     //Initialize program flags
     int d = PRETTY_PRINT, s = PRINT_STEP_COUNT, p = PRINT_OPTIMAL;
+    int e = PRINT_EXPANDED, v = PRINT_STATS, t = TILED, l = LABEL;
+    Solver m = SOLVER;
+    int j = THREADS;
+    char *batchloc = BATCH;
+    char *socketloc = SOCKET;
+    char *cacheloc = CACHE;
+    SolveCache cache = NULL;
+    char *indexloc = INDEX;
+    PathIndex index = NULL;
+    MazeCell* starts = NULL; // cells given by -f
+    size_t startCount = 0;
+    MazeCell goal;
+    int g = GOAL;
+    int w = CONVERT;
+    size_t limit = MEMORY_LIMIT;
+    MazeFormat format = MAZE_TEXT;
     FILE *i = INPUT_STREAM;
     FILE *o = OUTPUT_STREAM;
     
@@ -96,6 +396,91 @@ int main(int argc, char** argv) {
             case 'p':
                 p = 1;
                 break;
+            case 't':
+                t = 1;
+                break;
+            case 'l':
+                l = 1;
+                break;
+            case 'e':
+                e = 1;
+                break;
+            case 'v':
+                v = 1;
+                break;
+            case 'm':
+                if(!parse_solver(optarg, &m)) {
+                    fprintf(stderr, "%s: unknown mode\n", optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                break;
+            case 'j':
+                if((j = atoi(optarg)) < 1) {
+                    fprintf(stderr, "%s: thread count must be positive\n", 
+                                optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                break;
+            case 'b':
+                protected_free(batchloc);
+                batchloc = strdup(optarg);
+                break;
+            case 'S':
+                protected_free(socketloc);
+                socketloc = strdup(optarg);
+                break;
+            case 'c':
+                protected_free(cacheloc);
+                cacheloc = strdup(optarg);
+                break;
+            case 'H':
+                protected_free(indexloc);
+                indexloc = strdup(optarg);
+                break;
+            case 'f':
+                starts = realloc(starts, sizeof(MazeCell) * (startCount + 1));
+                if(starts == NULL) {
+                    perror("realloc");
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                if(!parse_cell(optarg, &starts[startCount++])) {
+                    fprintf(stderr, "%s: expected ROW,COLUMN\n", optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                break;
+            case 'g':
+                if(!parse_cell(optarg, &goal)) {
+                    fprintf(stderr, "%s: expected ROW,COLUMN\n", optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                g = 1;
+                break;
+            case 'w':
+                if(!parse_format(optarg, &format)) {
+                    fprintf(stderr, "%s: unknown format\n", optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                w = 1;
+                break;
+            case 'M':
+                if(!parse_limit(optarg, &limit)) {
+                    fprintf(stderr, "%s: expected a byte count\n", optarg);
+                    usage_message(stderr);
+                    exit = EXIT_FAILURE;
+                    goto end_program; // free all allocated memory before exiting
+                }
+                break;
             case 'i':
                 protected_free(inputloc);
                 inputloc = strdup(optarg);
@@ -123,28 +508,135 @@ int main(int argc, char** argv) {
         exit = EXIT_FAILURE;
         goto end_program; // free all allocated memory before exiting
     }    
-    if(outputloc != NULL && (o = fopen(outputloc, "w")) == NULL) {
+    // opened for reading too so large prints can map the file
+    if(outputloc != NULL && (o = fopen(outputloc, "w+")) == NULL) {
         perror(outputloc);
         exit = EXIT_FAILURE;
         goto end_program; // free all allocated memory before exiting
     }
+
+    if(cacheloc != NULL) {
+        // a damaged cache only costs the solutions it held,
+        // it is replaced when the cache is saved
+        cache = cache_create(CACHE_ENTRIES);
+        cache_load(cache, cacheloc);
+    }
+    if(socketloc != NULL) {
+        if(serve_mazes(socketloc, m, j, cache))
+            exit = EXIT_FAILURE;
+        goto end_program; // free all allocated memory before exiting
+    }
+    if(batchloc != NULL) {
+        size_t count = 0;
+        char** paths = strcmp(batchloc, "-")?batch_list_dir(batchloc, &count):
+                            batch_read_paths(stdin, &count);
+        if(paths == NULL)
+            exit = EXIT_FAILURE;
+        else if(batch_solve(paths, count, m, j, cache, o))
+            exit = EXIT_FAILURE;
+        if(paths != NULL) batch_free_paths(paths, count);
+        goto end_program; // free all allocated memory before exiting
+    }
+    if(limit) {
+        if(solve_bands(i, limit, d, s, p, e, v, o))
+            exit = EXIT_FAILURE;
+        goto end_program; // free all allocated memory before exiting
+    }
     
+    // seconds spent parsing, solving and printing, reported by -v
+    double phases[3] = {0, 0, 0}, start = now();
+    stats_reset();
     Maze maze = create_maze(i); 
+    phases[0] = now() - start;
+    if(maze == NULL) { // the reason was already reported by create_maze()
+        exit = EXIT_FAILURE;
+        goto end_program; // free all allocated memory before exiting
+    }
+    if(t)
+        set_maze_layout(maze, MAZE_TILES);
+    if(w) {
+        if(save_maze(maze, o, format) || fflush(o)) {
+            perror("write");
+            exit = EXIT_FAILURE;
+        }
+        clean_maze(maze);
+        goto end_program; // free all allocated memory before exiting
+    }
+    start = now();
+    size_t regions = (l)?label_maze(maze):0;
+    phases[1] = now() - start;
+    if(!g) {
+        goal.row = maze_height(maze) - 1;
+        goal.column = maze_width(maze) - 1;
+    }
+    MazeCell corner = {0, 0}; // where paths start when only -g is given
+    int field = g || startCount;
+    if(!field && indexloc != NULL && (index = hpa_load(maze, indexloc)) == NULL) {
+        // a missing or stale index is replaced by one of this maze
+        index = hpa_build(maze, 0);
+        if(hpa_save(index, indexloc))
+            exit = EXIT_FAILURE;
+    }
+    start = now();
     if(d)
         pretty_print_maze(maze, o); 
-    int steps = 0;
-    if(s || p)
-         steps = solve_maze(maze);
-    if(s && steps > 0)
+    phases[2] = now() - start;
+    int steps = 0, solve = s || p || e || v;
+    SolveStats stats = {0, 0};
+    start = now();
+    if(solve && field)
+        steps = solve_starts(maze, (startCount)?starts:&corner, 
+                    (startCount)?startCount:1, goal, s, &stats, o);
+    else if(solve && index != NULL)
+        steps = hpa_solve(index, maze, 0, 0, maze_height(maze) - 1, 
+                    maze_width(maze) - 1, &stats);
+    else if(solve && cache != NULL && j)
+        steps = cache_solve_parallel(cache, maze, j, &stats);
+    else if(solve && cache != NULL)
+        steps = cache_solve(cache, maze, m, &stats);
+    else if(solve && j)
+        steps = solve_maze_parallel(maze, j, &stats);
+    else if(solve)
+         steps = solve_maze_with(maze, m, &stats);
+    phases[1] += now() - start;
+    // every start given to the field was already answered
+    if(s && !field && steps > 0)
         fprintf(o, "Solution in %i steps.\n", steps);
-    else if(s)
+    else if(s && !field)
         fprintf(o, "No solution.\n");
+    if(e)
+        fprintf(o, "Expanded %lu cells, queued %lu.\n", 
+                stats.expanded, stats.pushed);
+    if(e && l)
+        fprintf(o, "Labeled %zu regions.\n", regions);
+    if(e && cache != NULL) {
+        CacheCounters counters;
+        cache_counters(cache, &counters);
+        fprintf(o, "Cache hits %lu, misses %lu, evictions %lu.\n", 
+                counters.hits, counters.misses, counters.evictions);
+    }
+    start = now();
     if(p)
         pretty_print_maze(maze, o); 
+    phases[2] += now() - start;
+    if(v)
+        print_stats(stderr, maze_width(maze), maze_height(maze), steps, 
+                    &stats, phases);
 
     clean_maze(maze);
+    hpa_destroy(index);
 
     end_program:
+    if(cache != NULL) {
+        if(exit == EXIT_SUCCESS && cache_save(cache, cacheloc))
+            exit = EXIT_FAILURE;
+        cache_destroy(cache);
+    }
+    protected_free(cacheloc);
+    protected_free(indexloc);
+    protected_free(starts);
+    protected_free(batchloc);
+    protected_free(socketloc);
     if(inputloc != NULL) {
         free(inputloc);
         fclose(i);
@@ -0,0 +1,157 @@
+/// File: pqueueADT.c
+/// Description: implementation of pqueueADT.h as a 4-ary heap,
+///     a wider heap is half as deep as a binary heap and the four 
+///     children of an entry share a cache line
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+#include "mazestats.h"
+
+#define ARITY 4 /// children per entry
+#define PARENT(index) (((index) - 1) / ARITY) /// index to parent from index
+#define CHILD(index) ((index) * ARITY + 1) /// index to first child from index
+#define MIN_CAPACITY 16 /// smallest amount of entries to allocate
+
+/// an item and its priority, stored directly in the heap
+typedef struct PQUEUE_ENTRY_ST {
+    uint64_t priority; /// lower priorities are removed first
+    uint64_t item; /// the value stored with the priority
+} Entry;
+
+struct PQUEUE_ST {
+    Entry* entries; /// the heap
+    size_t capacity; /// entries allocated
+    size_t num; /// entries in use
+    Arena arena; /// where entries are allocated from, NULL for malloc
+};
+
+#include "pqueueADT.h"
+
+/// Implementation from pqueueADT.h
+/// pq_create()
+///     create an empty priority queue
+PQueue pq_create(size_t capacity) {
+    PQueue pq = (PQueue)malloc(sizeof(struct PQUEUE_ST));
+    assert(pq != NULL);
+    pq->capacity = (capacity < MIN_CAPACITY)?MIN_CAPACITY:capacity;
+    pq->entries = malloc(sizeof(Entry) * pq->capacity);
+    assert(pq->entries != NULL);
+    pq->num = 0;
+    pq->arena = NULL;
+    return pq;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_create_in()
+///     create an empty priority queue whose memory comes from an arena
+PQueue pq_create_in(Arena arena, size_t capacity) {
+    PQueue pq = (PQueue)arena_alloc(arena, sizeof(struct PQUEUE_ST));
+    pq->capacity = (capacity < MIN_CAPACITY)?MIN_CAPACITY:capacity;
+    pq->entries = arena_alloc(arena, sizeof(Entry) * pq->capacity);
+    pq->num = 0;
+    pq->arena = arena;
+    return pq;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_destroy()
+///     frees the priority queue and its entries
+void pq_destroy(PQueue pq) {
+    assert(pq != NULL && pq->arena == NULL);
+    free(pq->entries);
+    free(pq);
+}
+
+/// Implementation from pqueueADT.h
+/// pq_clear()
+///     empties the priority queue, its storage is kept for reuse
+void pq_clear(PQueue pq) {
+    pq->num = 0;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_push()
+///     add an item to the priority queue
+void pq_push(PQueue pq, uint64_t priority, uint64_t item) {
+    if(pq->num == pq->capacity) {
+        pq->capacity *= 2;
+        if(pq->arena == NULL) {
+            pq->entries = realloc(pq->entries, sizeof(Entry) * pq->capacity);
+            assert(pq->entries != NULL);
+        } else { // the old entries are released with the arena
+            Entry* entries = arena_alloc(pq->arena, sizeof(Entry) * pq->capacity);
+            memcpy(entries, pq->entries, sizeof(Entry) * pq->num);
+            pq->entries = entries;
+        }
+    }
+    // move parents down until the hole is where the new entry belongs
+    size_t index = pq->num++;
+    STAT_ADD(STAT_QUEUE_PUSHES, 1);
+    STAT_MAX(STAT_QUEUE_PEAK, pq->num);
+    while(index && pq->entries[PARENT(index)].priority > priority) {
+        pq->entries[index] = pq->entries[PARENT(index)];
+        index = PARENT(index);
+        STAT_ADD(STAT_SIFT_LEVELS, 1);
+    }
+    pq->entries[index].priority = priority;
+    pq->entries[index].item = item;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_pop()
+///     remove the item with the lowest priority
+uint64_t pq_pop(PQueue pq, uint64_t* priority) {
+    assert(pq->num != 0);
+    Entry top = pq->entries[0];
+    Entry last = pq->entries[--pq->num];
+    STAT_ADD(STAT_QUEUE_POPS, 1);
+
+    // move the smallest child up until the hole is where last belongs
+    size_t index = 0;
+    for(;;) {
+        size_t child = CHILD(index);
+        if(child >= pq->num) break;
+        size_t end = (child + ARITY < pq->num)?child + ARITY:pq->num;
+        size_t smallest = child;
+        for(size_t sibling = child + 1; sibling < end; sibling++)
+            if(pq->entries[sibling].priority < pq->entries[smallest].priority)
+                smallest = sibling;
+        if(pq->entries[smallest].priority >= last.priority) break;
+        pq->entries[index] = pq->entries[smallest];
+        index = smallest;
+        STAT_ADD(STAT_SIFT_LEVELS, 1);
+    }
+    pq->entries[index] = last;
+
+    if(priority != NULL) *priority = top.priority;
+    return top.item;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_peek()
+///     looks at the item with the lowest priority without removing it
+uint64_t pq_peek(PQueue pq, uint64_t* priority) {
+    assert(pq->num != 0);
+    if(priority != NULL) *priority = pq->entries[0].priority;
+    return pq->entries[0].item;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_size()
+///     reports the amount of entries in the priority queue
+size_t pq_size(PQueue pq) {
+    return pq->num;
+}
+
+/// Implementation from pqueueADT.h
+/// pq_empty()
+///     reports if the priority queue is empty
+int pq_empty(PQueue pq) {
+    return pq->num == 0;
+}
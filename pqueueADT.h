@@ -0,0 +1,107 @@
+/// File: pqueueADT.h
+/// Description: a min priority queue of integer priorities and items,
+///     entries are stored inline so no memory is allocated per entry
+/// Author: Nicholas Chieppa nrc4867@rit.edu
+///
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "arenaADT.h"
+
+#ifndef PQUEUEADT
+#define PQUEUEADT
+
+typedef struct PQUEUE_ST* PQueue;
+
+/**
+ * pq_create()
+ *      create an empty priority queue
+ * args -
+ *      capacity - the amount of entries to reserve room for
+ * returns -
+ *      a pointer to an empty priority queue
+ */
+PQueue pq_create(size_t capacity);
+
+/**
+ * pq_create_in()
+ *      create an empty priority queue whose memory comes from an arena,
+ *      the queue is freed along with the arena and must not be
+ *      passed to pq_destroy()
+ * args -
+ *      arena - the arena to allocate from
+ *      capacity - the amount of entries to reserve room for
+ * returns -
+ *      a pointer to an empty priority queue
+ */
+PQueue pq_create_in(Arena arena, size_t capacity);
+
+/**
+ * pq_destroy()
+ *      frees the priority queue and its entries
+ * args -
+ *      pq - the priority queue to free
+ */
+void pq_destroy(PQueue pq);
+
+/**
+ * pq_clear()
+ *      empties the priority queue, its storage is kept for reuse
+ * args -
+ *      pq - the priority queue to empty
+ */
+void pq_clear(PQueue pq);
+
+/**
+ * pq_push()
+ *      add an item to the priority queue
+ * args -
+ *      pq - the priority queue to add to
+ *      priority - the priority of the item, lower comes out first
+ *      item - the item to add
+ */
+void pq_push(PQueue pq, uint64_t priority, uint64_t item);
+
+/**
+ * pq_pop()
+ *      remove the item with the lowest priority
+ * args -
+ *      pq - the priority queue to remove from, must not be empty
+ *      priority - location to store the priority of the item, may be NULL
+ * returns -
+ *      the item with the lowest priority
+ */
+uint64_t pq_pop(PQueue pq, uint64_t* priority);
+
+/**
+ * pq_peek()
+ *      looks at the item with the lowest priority without removing it
+ * args -
+ *      pq - the priority queue to look in, must not be empty
+ *      priority - location to store the priority of the item, may be NULL
+ * returns -
+ *      the item with the lowest priority
+ */
+uint64_t pq_peek(PQueue pq, uint64_t* priority);
+
+/**
+ * pq_size()
+ *      reports the amount of entries in the priority queue
+ * args -
+ *      pq - the priority queue to inspect
+ * returns -
+ *      the amount of entries
+ */
+size_t pq_size(PQueue pq);
+
+/**
+ * pq_empty()
+ *      reports if the priority queue is empty
+ * args -
+ *      pq - the priority queue to inspect
+ * returns -
+ *      1 if the priority queue is empty 0 otherwise
+ */
+int pq_empty(PQueue pq);
+
+#endif // PQUEUEADT
@@ -0,0 +1,36 @@
+/// File: stackADT.h
+/// Description: an unbounded stack of pointers, implemented by stackADT2.c
+///
+
+#ifndef STACKADT
+#define STACKADT
+
+#include <stdbool.h>
+
+typedef struct stackStruct *StackADT;
+
+/// create an empty stack, or NULL when out of memory
+StackADT stk_create( void );
+
+/// free a stack, the items are the client's to free
+void stk_destroy( StackADT stack );
+
+/// remove every item from a stack
+void stk_clear( StackADT stack );
+
+/// push an item on top of a stack
+void stk_push( StackADT stack, void *data );
+
+/// remove and return the top item of a stack that is not empty
+void *stk_pop( StackADT stack );
+
+/// return the top item of a stack that is not empty
+void *stk_top( StackADT stack );
+
+/// true when a stack holds no items
+bool stk_empty( StackADT stack );
+
+/// true when a stack can't grow, never for this stack
+bool stk_full( StackADT stack );
+
+#endif // STACKADT